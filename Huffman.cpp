@@ -8,41 +8,21 @@
  * operation. Than doing selected operation and display name of result file.
  */
 
-#include <fstream>
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <vector>
 
-#include "pqueueshpp.h"
-
+#include "archiver.h"
 
 using namespace std;
 
-/* Structure to save characters in binary tree*/
-struct TreeNode {
-    char ch;
-    bool isBusy = false;
-    TreeNode *left, *right;
-};
-
 /* Function prototypes*/
-void archiveFile(string sourceFilename, string resultFilename);
-int* getAlphabet(ifstream &infile, int &sourceFileLength);
-PQueueSHPP<TreeNode*> getQueue (int *alphabet);
-TreeNode* getTree(PQueueSHPP<TreeNode*> queue);
-void getTable(TreeNode* tree, string way, string *table);
-string getAlphabetForFile(int *alphabet);
-string getCodeFromFile(ifstream &archivedFile, int sourceFileLength);
-int* parseCodeString(string codeString);
-void writeArchiveFile(ifstream &sourceFile, string code, string archiveName, int sourceFileLength, string *table);
-void dearchiveFile(string archiveName, string resultName);
-char* getBodyFromFile(ifstream &file, int delCh, int& bodySize);
-void writeDeArchFile(string fileName, char* body, TreeNode *root, int sourceFileLength, int bodySize);
-int getLengthFromArchive(ifstream &archivedFile);
-char strToByte(string byte);
-string getBitsFromChar(char ch);
-void clearTree(TreeNode* tree);
-
-const int BYTES_NUMBER = 256;
+bool parseOptions(char* argv[], int firstOption, int lastOption, ArchiveOptions &options);
+bool parseRange(string range, uint64_t &offset, uint64_t &length);
+bool parseTableId(string value, uint64_t &id);
+int findOptionsEnd(char* argv[], int firstOption, int argc);
 
 
 /* Main program */
@@ -50,16 +30,51 @@ int main(int argc, char* argv[]) {
 
     string command;
     string filename;
+    ArchiveOptions options;
+    uint64_t rangeOffset = 0, rangeLength = 0; // range of the source file for "-x" command
+    uint64_t tableId = 0; // number of the trained table for "-train" command
+    string memberName; // file of the container for "-get" command
+    vector<string> sourceNames; // files and directories for "-pack" command
 
-    if (argc == 3){
+    if (argc >= 2){
         command = argv[1];
-        filename = argv[2];
+        int firstOption = 2;
+        int lastOption = argc - 1; // filename goes after the options
+        if (command == "-c" || command == "-d"){
+            lastOption = argc; // standard streams are used instead of the files
+        } else if (argc < 3){
+            command = "";
+        }
+        if (command == "-x"){
+            if (argc < 4 || !parseRange(argv[2], rangeOffset, rangeLength)) command = "";
+            firstOption = 3;
+        }
+        if (command == "-train"){
+            if (argc < 4 || !parseTableId(argv[2], tableId)) command = "";
+            firstOption = 3;
+        }
+        if (command == "-get"){
+            if (argc < 4) command = "";
+            memberName = argv[2];
+            firstOption = 3;
+        }
+        if (command == "-pack"){
+            lastOption = findOptionsEnd(argv, firstOption, argc); // name of the container and packed files go after the options
+            if (argc - lastOption < 2) command = "";
+            sourceNames.assign(argv + min(lastOption + 1, argc), argv + argc);
+        }
+        if (parseOptions(argv, firstOption, lastOption, options)){
+            if (lastOption < argc) filename = (command == "-pack") ? argv[lastOption] : argv[argc - 1];
+        } else {
+            command = "";
+        }
     }
 
     if (command == "-ar"){
         try{
             cout << "Processing... " << endl << endl;
-            archiveFile(filename, filename + ".huf");
+            Archiver archiver(options);
+            archiver.archiveFile(filename, filename + ".huf");
             cout << "Archivation done. File: (" << filename + ".huf) " << "created." << endl;
         }
         catch(...){
@@ -69,7 +84,8 @@ int main(int argc, char* argv[]) {
         try{
             if (filename.substr(filename.length() - 4) == ".huf"){
                 cout << "Processing... " << endl << endl;
-                dearchiveFile(filename, "ORIGINAL_"+filename.substr(0, filename.length() - 4));
+                Archiver archiver(options);
+                archiver.dearchiveFile(filename, "ORIGINAL_"+filename.substr(0, filename.length() - 4));
                 cout << "Extraction done!!! File("<< "ORIGINAL_"+filename.substr(0, filename.length() - 4) << ") created" << endl;
             } else {
                 cout << "File is not Huffman archive" << endl;
@@ -78,8 +94,113 @@ int main(int argc, char* argv[]) {
         catch (...){
             cerr << "Error while decompressing file" << endl;
         }
+    } else if (command == "-c" || command == "-d"){
+        ios::sync_with_stdio(false);
+        try{
+            Archiver archiver(options);
+            if (command == "-c"){
+                archiver.encodeStream(cin, cout);
+            } else {
+                archiver.decodeStream(cin, cout);
+            }
+        }
+        catch (...){
+            cerr << ((command == "-c") ? "Error while compressing stream" : "Error while decompressing stream") << endl;
+            return 1;
+        }
+    } else if (command == "-train"){
+        try{
+            Archiver archiver(options);
+            archiver.trainTable(filename, tableId);
+            cout << "Shared table " << tableId << " created from " << filename << endl;
+        }
+        catch (...){
+            cerr << "Error while training shared table" << endl;
+            return 1;
+        }
+    } else if (command == "-pack"){
+        try{
+            cout << "Processing... " << endl << endl;
+            Archiver archiver(options);
+            archiver.packFiles(sourceNames, filename + ".hufc");
+            cout << "Packing done. File: (" << filename + ".hufc) " << "created." << endl;
+        }
+        catch (...){
+            cerr << "Error while packing files" << endl;
+            return 1;
+        }
+    } else if (command == "-unpack"){
+        try{
+            if (filename.length() > 5 && filename.substr(filename.length() - 5) == ".hufc"){
+                cout << "Processing... " << endl << endl;
+                Archiver archiver(options);
+                archiver.unpackFiles(filename, "ORIGINAL_" + filename.substr(0, filename.length() - 5));
+                cout << "Extraction done!!! Directory(" << "ORIGINAL_" + filename.substr(0, filename.length() - 5) << ") created" << endl;
+            } else {
+                cout << "File is not Huffman container" << endl;
+            }
+        }
+        catch (...){
+            cerr << "Error while unpacking files" << endl;
+            return 1;
+        }
+    } else if (command == "-list"){
+        try{
+            Archiver archiver(options);
+            vector<ArchiveMember> members = archiver.listMembers(filename);
+            for (size_t i = 0; i < members.size(); i++){
+                cout << members[i].sourceLength << "\t" << members[i].archiveSize << "\t" << members[i].name << endl;
+            }
+        }
+        catch (...){
+            cerr << "Error while reading container" << endl;
+            return 1;
+        }
+    } else if (command == "-get"){
+        try{
+            Archiver archiver(options);
+            archiver.extractMember(filename, memberName, cout);
+        }
+        catch (...){
+            cerr << "Error while extracting file" << endl;
+            return 1;
+        }
+    } else if (command == "-t"){
+        try{
+            Archiver archiver(options);
+            uint64_t length = archiver.verifyFile(filename);
+            cout << "Archive " << filename << " is correct, " << length << " bytes checked" << endl;
+        }
+        catch (...){
+            cerr << "Archive " << filename << " is corrupted" << endl;
+            return 1;
+        }
+    } else if (command == "-x"){
+        try{
+            Archiver archiver(options);
+            archiver.extractRange(filename, rangeOffset, rangeLength, cout);
+        }
+        catch (...){
+            cerr << "Error while extracting range" << endl;
+            return 1;
+        }
     } else {
         cout << "Please enter a valid command \"-ar filename\" to archive file, \"-de filename\" to dearchive file!!!" << endl;
+        cout << "Command \"-x offset:length filename\" writes only specified bytes of the archived file to the standard output" << endl;
+        cout << "Commands \"-c\" and \"-d\" archive and dearchive standard input to the standard output" << endl;
+        cout << "Command \"-t filename\" checks the archive or the container without writing the decoded data" << endl;
+        cout << "Command \"-train id filename\" builds shared code table number \"id\" from the sample file" << endl;
+        cout << "Command \"-pack name files...\" packs files and directories to the container \"name.hufc\", "
+             << "\"-unpack name.hufc\" restores all its files, \"-list name.hufc\" prints sizes and names of the files, "
+             << "\"-get file name.hufc\" writes one file to the standard output" << endl;
+        cout << "Archivation options: \"-l length\" maximal code length from " << MIN_CODE_LENGTH_LIMIT << " to "
+             << DecodeTable::MAX_TABLE_CODE_LENGTH << " bits (" << DEFAULT_MAX_CODE_LENGTH << " by default), "
+             << "\"-j threads\" number of threads (1 by default), \"-a\" adaptive coding in one pass, "
+             << "\"-s\" frequencies estimated by the sample of every block, \"-o\" order-1 coding by the tables "
+             << "of the previous characters, \"-i\" block divided into " << STREAMS_NUMBER
+             << " streams for faster decoding, "
+             << "\"-u id\" all blocks coded by the shared table, \"-T directory\" directory of the shared tables "
+             << "(current by default)" << endl;
         return 0;
     }
 
@@ -87,554 +208,122 @@ int main(int argc, char* argv[]) {
     return 0;
 }
 
-
-//-----------------------Encoding------------------------------------------------------
-/** Function: archiveFile
- * Usage: archiveFile(sourceFileName, sourceFileName + ".huf");
+/** Function: parseOptions
+ * Usage: if (parseOptions(argv, 2, argc - 1, options))...
  * ------------------------------------------------------------------------------------
  *
- * This function implements file encoding using Huffman's algoritm.
- * At the beginning it builds an alphabet of the characters and their frequency of use in the file.
- * After that builds the priority queue of all of these characters using frequency as a priority.
- * Then build binary tree based on the queue. Using this tree our function builds new table for coding
- * characters in the source file using less bits for commonly used characters. After this it write
- * output compressed file with length of source file, coding table in string format separated with
- * double braces from other part of the file with recoded body of the source file.
- *
- * @param sourceFileName Name of the source file
- * @param resultFilename Name of the output archive file
+ * This function reads options placed after the command in the command line
+ * and saves them to the received structure. Options which are not set keep default values.
  *
+ * @param argv Command line arguments
+ * @param firstOption Index of the first option after the command and its arguments
+ * @param lastOption Index of the argument after the last option
+ * @param options Structure for the options
+ * @return false if some option is unknown or has invalid value
  */
-
-void archiveFile(string sourceFilename, string resultFilename){
-
-    PQueueSHPP<TreeNode*> queue; // queue for building the tree
-    ifstream sourceFile(sourceFilename, ifstream::binary);
-
-    int sourceFileLength = 0;
-
-    /* Alphabet with all characters used in the source file and their frequencies */
-    int *alphabet = getAlphabet(sourceFile, sourceFileLength);
-    sourceFile.close();
-
-
-    /* Queue for building the tree*/
-    queue = getQueue(alphabet);
-
-    /* Huffman tree generated from the exact frequencies of the text */
-    TreeNode* tree = getTree(queue);
-
-
-    /* Table for coding characters saved in the array "table" */
-    string way = ""; // way to the character in the binary tree in format "010100..."
-    string* table = new string[BYTES_NUMBER];
-    getTable(tree, way, table);
-
-
-    /* Alphabet with all characters used in the source file and their frequencies
-     * stored in string format and separators for subsequent writing to the archive file
-     */
-    string alphabetForFile = getAlphabetForFile(alphabet);
-
-
-    /* Writing the result archive file with source file length, table for encoding and new body*/
-    sourceFile.open(sourceFilename, ifstream::binary);
-    writeArchiveFile(sourceFile, alphabetForFile, resultFilename, sourceFileLength, table);
-    delete[] table;
-    delete[] alphabet;
-    clearTree(tree);
-    sourceFile.close();
-}
-
-/** Function: getAlphabet
- * Usage: alphabet = getAlphabet(sourceFile, sourceFileLength);
- * --------------------------------------------------------------------------------------------
- *
- * This function read all characters in the recieved file stream and put their
- * frequencies to the array. Also it change the value of variable sourceFileLength, what will
- * be used in the reult file.
- *
- * @param &infile Link to the opened input file.
- * @param &sourceFileLength Link to variable for storing source file length.
- * @return array with the frequencies of the characters
- */
-int* getAlphabet(ifstream &sourceFile, int &sourceFileLength){
-    int *alphabet = new int[BYTES_NUMBER];
-    for(int i = 0; i < BYTES_NUMBER; i++){
-        alphabet[i] = 0;
-    }
-
-    /* Reading whole source file to char array*/
-    sourceFile.seekg(0, sourceFile.end);
-    int length = sourceFile.tellg();
-    sourceFile.seekg(0, sourceFile.beg);
-    sourceFileLength = length;
-    char *buffer = new char[length];
-    sourceFile.read(buffer, length);
-
-    for(int i = 0; i < length; i++){
-        char ch = buffer[i];
-        alphabet[(unsigned char)ch]++;
-    }
-
-    return alphabet;
-}
-
-/** Function: getQueue
- * Usage: queue = getQueue(alphabet);
- * ---------------------------------------------------------------------------------
- *
- * This function build priority queue for Huffman's algoritm based on the
- * alphabet of the source file. Priority of every new element in it's queue
- * is equal to frequency in the alphabet.
- *
- * @param alphabet array with the frequencies of the characters
- * @return Ready priority queue with right priorities of every characters.
- */
-PQueueSHPP<TreeNode*> getQueue(int *alphabet){
-
-    PQueueSHPP<TreeNode*> queue;
-
-    for(int i = 0; i < BYTES_NUMBER; i++){
-        if(alphabet[i] != 0){
-            unsigned char ch = i;
-            TreeNode *node = new TreeNode;
-            node->left = node->right = 0;
-            node->ch = ch;
-            node->isBusy = true;
-            queue.enqueue(node, alphabet[i]);
-
-        }
-    }
-    return queue;
-}
-
-
-/** Function: getTree
- * Usage:  BSTNode* tree = getTree(queue);
- * ---------------------------------------------------------------------
- *
- * This function builds binary tree for Huffman's algoritm based on the
- * received priority queue. It combines two elements of the queue with minimum
- * in one new element and put it in the queue with priority equals to
- * summ of priorities of this two elements.
- *
- * @param queue Priority queue with all characters of the source file.
- * @return Binary tree for the Huffman's algoritm.
- */
-TreeNode* getTree(PQueueSHPP<TreeNode*> queue){
-
-    while(queue.size() != 1){
-        int newPriority = queue.peekPriority();
-
-        TreeNode* newNode = new TreeNode;
-        newNode->ch = 0;
-        newNode->left = queue.dequeue();
-        newPriority += queue.peekPriority();
-
-        newNode->right = queue.dequeue();
-        queue.enqueue(newNode, newPriority);
-
-    }
-    return queue.dequeue(); // last element of the queue
-}
-
-/** Function: getTable
- * Usage: getTable(tree, way, table);
- * ----------------------------------------------------------------------
- *
- * Function used for building new coding table for all characters depends on
- * it's frequensies in the source. It go through binary tree and on the way
- * to the character add's "1" or "0" to new code of character ("1" - if turned right
- * and "0" - if turned left).
- * New code for most frequently used characters consist of less number of bits.
- *
- * @param tree Pointer to the binary tree with all characters
- * @param way String variable to store new code for character
- * @param table array of new bit codes of the characters in the string format.
- */
-void getTable(TreeNode *tree, string way, string *table){
-    if (tree != 0){
-        getTable(tree->left, way + "0", table);
-        if (tree->isBusy){
-            table[(int)(unsigned char)tree->ch] = way;
-        }
-        getTable(tree->right, way + "1", table);
-    } else {
-        return;
-    }
-}
-
-/** Function: getAlphabetForFile
- * Usage: string alphabetForFile = getAlphabetForFile(alphabet);
- * ----------------------------------------------------------------------
- *
- * This fuction transform alphabet of the source file to the specified string format
- * for writing int the output archive file.
- *
- * @param alphabet array with the frequencies of the characters
- * @return Alphabet array transformed in the specified string.
- */
-string getAlphabetForFile(int *alphabet){
-    string result;
-    for(int i = 0; i < BYTES_NUMBER; i++){
-        if(alphabet[i] != 0){
-            unsigned char ch = i;
-            result += ch;
-            result += to_string(alphabet[i]);
-            result += ';';
-        }
-    }
-    result += "}}"; //mark end of the coding table in archive file
-    return result;
-}
-
-
-/** Function: writeArchiveFile
- * Usage:  writeArchiveFile(sourceFile, alphabetForFile, resultFilename, sourceFileLength, table);
- * ------------------------------------------------------------------------------------------
- *
- * This function creates and writes output archive file with specified structure.
- * At the begining of the file placed information about length of ource file (sourceFileLength),
- * after this alphabet for decoding file (alphabetForFile), then recoded source file body in
- * the binary mode.
- *
- * @param sourceFile Name of the source file.
- * @param code Alphabet for decodng in string format.
- * @param archiveName Name of the output archive file.
- * @param sourceFileLength Length of the source file.
- * @param table array of new bit codes of the characters.
- */
-void writeArchiveFile(ifstream &sourceFile, string code, string archiveName, int sourceFileLength, string *table){
-
-    ofstream outFile(archiveName, ofstream::binary);
-    outFile << to_string(sourceFileLength) << "{" << code;
-
-    /* Reading whole source file to char array*/
-    sourceFile.seekg(0, sourceFile.end);
-    int length = sourceFile.tellg();
-    sourceFile.seekg(0, sourceFile.beg);
-    char *buffer = new char[length];
-    sourceFile.read(buffer, length);
-
-
-    /* Go through char array, code all characters according to coding table in combination of bits
-    *  and write it's binary values to string .
-    */
-
-    string bodyBitStr = "";
-    for (int j = 0; j < length; j++) {
-        char ch = buffer[j];
-        bodyBitStr += table[(int)(unsigned char)ch];
-    }
-
-    /* Split bodyBitStr into portions of 8 bits, transorm them to real bytes and write them to the file.*/
-    int count = bodyBitStr.size() / 8;
-    if(bodyBitStr.size() % 8 != 0) {
-        count++;
-    }
-
-    for(int i = 0; i < count; i++){
-        string part = bodyBitStr.substr(i * 8, 8);
-        char ch = strToByte(part);
-        outFile.write((char*)&ch, sizeof(ch));
-    }
-
-    delete[] buffer;
-    outFile.close();
-}
-
-/**
- * Function: strToByte
- * Usage:  char ch = strToByte(part);
- * ----------------------------------------------------------------------------
- *
- * This function transfor received string that contains 8 '0' or '1' to real byte.
- *
- * @param byte String with 8 '0' and '1'
- * @return Real char value of received string
- */
-char strToByte(string byte){
-    int result = 0;
-    int currentBitValue = 128;
-
-    for (int i = 0; i < 8; i++){
-        if (byte[i] == '1'){
-            result += currentBitValue;
+bool parseOptions(char* argv[], int firstOption, int lastOption, ArchiveOptions &options){
+    for (int i = firstOption; i < lastOption; i++){
+        string option = argv[i];
+        if (option == "-a"){
+            options.adaptive = true;
+        } else if (option == "-s"){
+            options.sampled = true;
+        } else if (option == "-o"){
+            options.contextModel = true;
+        } else if (option == "-i"){
+            options.interleaved = true;
+        } else if (option == "-u" && i + 1 < lastOption){
+            if (!parseTableId(argv[++i], options.sharedTable)) return false;
+        } else if (option == "-T" && i + 1 < lastOption){
+            options.tablesDirectory = argv[++i];
+        } else if ((option == "-l" || option == "-j") && i + 1 < lastOption){
+            int value;
+            try{
+                value = stoi(argv[++i]);
+            }
+            catch(...){
+                return false;
+            }
+            if (option == "-l"){
+                if (value < MIN_CODE_LENGTH_LIMIT || value > DecodeTable::MAX_TABLE_CODE_LENGTH) return false;
+                options.maxCodeLength = value;
+            } else {
+                if (value < 1) return false;
+                options.threadsNumber = value;
+            }
+        } else {
+            return false;
         }
-        currentBitValue /=2;
     }
-    return (unsigned char) result;
+    return true;
 }
 
-
-
-
-//------------------------Decoding-----------------------------------------------------
-
-/** Function: dearchiveFile
- * Usage: dearchiveFile(archiveFileName, "ORIGINAL_"+archiveFileName.substr(0, archiveFileName.length() - 4));
+/** Function: findOptionsEnd
+ * Usage: int lastOption = findOptionsEnd(argv, 2, argc);
  * ------------------------------------------------------------------------------------
  *
- * This function open archive file with received name and decode them. At the begining it read length of the
- * source file, than it read and parse decoding table and after this read other part of the
- * archive file, decode it and write the output file with received name.
- *
- * @param archiveName Name of the input archive file
- * @param resultName Name of the output result file.
- */
-void dearchiveFile(string archiveName, string resultName){
-    ifstream archivedFile(archiveName, ifstream::binary);
-
-    /* Reading length of the source file from archive */
-    int sourceFileLength = getLengthFromArchive(archivedFile);
-
-    /* Reading string with encoding table*/
-    string codeString = getCodeFromFile(archivedFile, sourceFileLength);
-
-    /* Writing string with encoding table to array*/
-    int* alphFromFile = parseCodeString(codeString);
-
-    /* Reading body of the source file from archive*/
-    int bodySize;
-    char* inputFileBody = getBodyFromFile(archivedFile, codeString.length() + 3 + to_string(sourceFileLength).length(), bodySize);
-    archivedFile.close();
-
-    /* Queue for building the tree generated from encoding table*/
-    PQueueSHPP<TreeNode*> queue = getQueue(alphFromFile);
-
-    /* Huffman tree generated from the encoding table */
-    TreeNode * root = getTree(queue);
-
-    /* Writing encoded file*/
-    writeDeArchFile(resultName, inputFileBody, root, sourceFileLength, bodySize);
-    delete[] alphFromFile;
-    clearTree(root);
-}
-
-/**
- * Function: getLengthFromArchive
- * Usage: int sourceFileLength = getLengthFromArchive(archivedFile);
- * --------------------------------------------------------------------------------
- *
- * This function read length of the source file writed in the archve file.
- * It read some first characters of the input file stream while not
- * meeted "{" symbol. Then convert it to integer.
+ * This function skips options placed after the command together with their values and finds
+ * first argument which is not an option, for commands with several filenames at the end.
  *
- * @param archivedFile Input file stream with opened archive file.
- * @return Integer length of the source file.
+ * @param argv Command line arguments
+ * @param firstOption Index of the first option after the command and its arguments
+ * @param argc Number of the arguments
+ * @return Index of the argument after the last option
  */
-int getLengthFromArchive(ifstream &archivedFile){
-    string result = "";
-    unsigned char currentCh = archivedFile.get();
-    while ((int)currentCh != 123) {
-        result += currentCh;
-        currentCh = archivedFile.get();
+int findOptionsEnd(char* argv[], int firstOption, int argc){
+    int i = firstOption;
+    while (i < argc && argv[i][0] == '-'){
+        string option = argv[i];
+        i += (option == "-l" || option == "-j" || option == "-u" || option == "-T") ? 2 : 1;
     }
-    return stoi(result);
+    return min(i, argc);
 }
 
-/**
- * Function: getCodeFromFile
- * Usage: string codeString = getCodeFromFile(archivedFile);
- * -----------------------------------------------------------------------------
- * This function read coding table from the input file stream. It read some
- * first characters of the input file stream while not meeted "}}" symbols.
+/** Function: parseRange
+ * Usage: if (parseRange(argv[2], rangeOffset, rangeLength))...
+ * ------------------------------------------------------------------------------------
  *
- * @param archivedFile Input file stream with opened archive file.
- * @return String with coding table.
- */
-string getCodeFromFile(ifstream &archivedFile, int sourceFileLength){
-    string result = "";
-
-    archivedFile.seekg(0, archivedFile.end);
-    int length = archivedFile.tellg();
-    archivedFile.seekg(0, archivedFile.beg);
-
-    int skip = to_string(sourceFileLength).size() + 1;
-    for (int i = 0; i < skip; i++){
-        archivedFile.get();
-    }
-
-    unsigned char currentCh = archivedFile.get();
-    unsigned char nextCh = archivedFile.get();
-    for(int i = 0; i < length - 2; i++){
-        if ((int)currentCh == 125 && (int)nextCh == 125){
-            break;
-        }
-        result += currentCh;
-        currentCh = nextCh;
-        nextCh = archivedFile.get();
-    }
-
-    return result;
-}
-
-/**
- * Function: parseCodeString
- * Usage:int *alphFromFile = parseCodeString(codeString);
- * -----------------------------------------------------------------------------------
+ * This function reads range of the source file in format "offset:length".
  *
- * This function parsing coding table and save it to array of the frequensies of the characters
- * in the source file.
- * @param codeString Coding table in the string format.
- * @return array with the frequencies of the characters.
+ * @param range String with the range
+ * @param offset Variable for the first byte of the range
+ * @param length Variable for the number of bytes in the range
+ * @return false if string has wrong format
  */
-int* parseCodeString(string codeString){
-    int* result = new int[BYTES_NUMBER];
-    for(int i = 0; i < BYTES_NUMBER; i++){
-        result[i] = 0;
+bool parseRange(string range, uint64_t &offset, uint64_t &length){
+    size_t separator = range.find(':');
+    if (separator == string::npos || separator == 0 || separator + 1 == range.length()) return false;
+    if (range.find_first_not_of("0123456789:") != string::npos || range.find(':', separator + 1) != string::npos){
+        return false;
     }
-
-    bool keyTrig = true; // trigger to separate character
-    bool valueTrig = false; // trigger to separate frequensy
-    char key;
-
-    string valueString;
-    for (int i = 0; i < codeString.length(); i++){
-        if (keyTrig){ //write key
-            key = codeString[i];
-            keyTrig = false; // switch to reading value
-            valueTrig = true;
-            continue;
-        }
-
-        if(valueTrig && codeString[i] != ';'){ //read frequensy until met with the separator ";"
-            valueString += codeString[i];
-            continue;
-        }
-
-        if(!keyTrig && codeString[i] == ';'){
-
-            result[(int)(unsigned char)key] = stoi(valueString); // write frequensy to array
-            keyTrig = true; // reset triggers to start again readint next key
-            valueTrig = false;
-            valueString.clear();
-            continue;
-        }
+    try{
+        offset = stoull(range.substr(0, separator));
+        length = stoull(range.substr(separator + 1));
     }
-    return result;
-}
-
-/**
- * Function: getBodyFromFile
- * Usage: string inputFileBody = getBodyFromFile(archivedFile, codeString.length() + 3 + integerToString(sourceFileLength).length());
- * --------------------------------------------------------------------------------------
- *
- * This function read body of the source file from the input archive file. It read whole file
- * and then delete the part of file from the begining to the end of coding table.
- * @param file Link to the input archive file stream.
- * @param delCh Number of characters to delete from the begining.
- * @return Body of the source file saved it the string.
- */
-char* getBodyFromFile(ifstream &file, int delCh, int& bodySize){
-
-    /* Determining the size of the file */
-    file.seekg(0, file.end); // set cursor position to the end of file
-    int length = file.tellg(); // tell it's position
-    file.seekg(0, file.beg); // set cursor position to the begining of file
-
-    /* Read entire file to char array*/
-    char *buffer = new char[length];
-    file.read(buffer, length);
-
-    bodySize = length - delCh;
-
-    int j = 0;
-    char *result = new char[length - delCh];
-    for (int i = delCh; i < length; i++){
-        result[j] = buffer[i];
-        j++;
+    catch(...){
+        return false;
     }
-    return result;
+    return true;
 }
 
-/**
- * Function: writeDeArchFile
- * Usage: writeDeArchFile(resultName, inputFileBody, root, sourceFileLength);
- * -------------------------------------------------------------------------------------
+/** Function: parseTableId
+ * Usage: if (parseTableId(argv[2], tableId))...
+ * ------------------------------------------------------------------------------------
  *
- * This function decoding the archive file and write the output result file. It receive
- * link to the coded body, binary tree for decoding and length of the source file. In the decoding
- * process it write output file with received name. The main idea of decoding is to go though
- * coded body in binary mode. When meeted "1", programm turns right in the binary tree, and left
- * if "0". Proceed this operation until not meeted character in binary tree. After this programm
- * writes it character to the result file and return to the root of the tree. It stop this
- * operation when length of the output file equals length of the source file.
+ * This function reads number of the shared table, which should be positive.
  *
- * @param fileName Name of the output result file.
- * @param body Body of the source file in string format.
- * @param root Binary tree with characters for decoding.
- * @param sourceFileLength Length of the source file.
+ * @param value String with the number
+ * @param id Variable for the number of the table
+ * @return false if string is not a positive number
  */
-void writeDeArchFile(string fileName, char* body, TreeNode *root, int sourceFileLength, int bodySize){
-    string bitStr = "";
-
-    for (int i = 0; i < bodySize; i++){
-        bitStr += getBitsFromChar(body[i]);
+bool parseTableId(string value, uint64_t &id){
+    if (value.empty() || value.find_first_not_of("0123456789") != string::npos) return false;
+    try{
+        id = stoull(value);
     }
-
-    ofstream result(fileName, ios::out | ios::binary);
-
-    int chCounter = 0;
-    TreeNode *node = root;
-
-    for (unsigned int i = 0; i < bitStr.size(); i++) {
-        if (bitStr[i] == '1') {
-            node = node->right; // turn right if 1
-        } else if (bitStr[i] == '0') {
-            node = node->left; // turn left if 0
-        }
-
-        /* if character found add it to the result file and back to start of the tree*/
-        if (node->isBusy){
-            char byte = node->ch;
-            result.write((char*)&byte, sizeof(byte));
-            chCounter++;
-            node = root;
-            if(chCounter == sourceFileLength) break; //stop writing the result file if achieved length of the source file
-        }
-
-
+    catch(...){
+        return false;
     }
-    result.close();
+    return id != 0;
 }
 
-/**
- * Function: getBitsFromChar
- * Usage: bitStr += getBitsFromChar(body[i]);
- * -----------------------------------------------
- * This function convert received byte in string
- * of '0' and '1'
- *
- * @param ch Received byte of char type
- * @return Byte in string representaion
- */
-string getBitsFromChar(char ch){
-    string result;
-    for(int i = 7; i >= 0; i--){
-        int bit = (ch >> i) & 1;
-        result += to_string(bit);
-    }
-    return result;
-}
-
-
-/**
- * Function: clearTree
- * Usage: clearTree(tree);
- *
- * -------------------------------------------------
- * Frees memory allocated for Huffmans tree
- *
- * @param tree Pointer to tree node
- */
-void clearTree(TreeNode *tree){
-    if (tree->left != 0){
-        clearTree(tree->left);
-    }
-    if (tree->right != 0){
-        clearTree(tree->right);
-    }
-    delete tree;
-}
@@ -12,6 +12,9 @@ TARGET = hello
 CONFIG   += console
 CONFIG   -= app_bundle
 CONFIG += c++11
+CONFIG += thread
+
+DEFINES += _FILE_OFFSET_BITS=64
 
 TEMPLATE = app
 
@@ -19,5 +22,4 @@ TEMPLATE = app
 SOURCES += \
     Huffman.cpp
 
-HEADERS += \
-    pqueueshpp.h
+include(huffmanlib.pri)
@@ -0,0 +1,1489 @@
+/* File: archiver.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements the archiver. Archive starts with signature, version of the format and
+ * size of the block, then goes blocks and zero length marks the end of the blocks. At the end
+ * of the archive goes index of the blocks, which allows decoding them in parallel.
+ * Container of many files has blocks of all files one after another, blocks of every file are
+ * separate from others, and a directory with names and sizes of the files at the end.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <stdexcept>
+#include <streambuf>
+
+#include "archiver.h"
+#include "checksum.h"
+#include "filetree.h"
+#include "mappedfile.h"
+
+using namespace std;
+
+/* Function prototypes*/
+int nextBlocks(const char *data, uint64_t length, uint64_t &position, vector<ArchiveBlock> &blocks);
+int readBlocks(istream &in, vector<ArchiveBlock> &blocks);
+void encodeBlock(ArchiveBlock &block, const ArchiveOptions &options, const SharedTable *sharedTable);
+void encodeHuffmanBlock(ArchiveBlock &block, const ArchiveOptions &options);
+void storeBlock(ArchiveBlock &block);
+bool isRun(const char *data, size_t length);
+uint64_t writeHeader(ostream &out, const char *signature);
+uint64_t writeBlock(ostream &out, const ArchiveBlock &block);
+void writeIndex(ostream &out, uint64_t indexOffset, const vector<BlockInfo> &blocks);
+void writeDirectory(ostream &out, uint64_t directoryOffset, const vector<ArchiveMember> &members);
+void writeOffset(ostream &out, uint64_t offset, const char *signature);
+int writeVarInt(ostream &out, uint64_t value);
+void appendVarInt(string &out, uint64_t value);
+ArchiveIndex readArchiveIndex(const char *archive, uint64_t size);
+uint64_t readHeader(const char *archive, uint64_t size, const char *signature, uint64_t &blockSize);
+uint64_t readOffset(const char *archive, uint64_t size, const char *signature);
+vector<ArchiveMember> readDirectory(const char *archive, uint64_t size, uint64_t &blockSize);
+ArchiveIndex readMemberIndex(const char *archive, uint64_t blockSize, const ArchiveMember &member);
+string getMemberName(const string &filename);
+bool isSafeMemberName(const string &name);
+void openMemberFile(ofstream &out, const string &filename);
+uint64_t readStreamHeader(istream &in, uint64_t &archiveSize);
+void readStreamIndex(istream &in, uint64_t indexOffset, const vector<BlockInfo> &blocks);
+void readBlock(const char *archive, const BlockInfo &info, char *out, SharedTableCache &tables);
+void decodePayload(const char *payload, const char *end, char *out, uint64_t length, SharedTableCache &tables);
+uint64_t readVarInt(const char *&data, const char *end);
+uint64_t readVarInt(istream &in, uint64_t &bytesRead);
+uint32_t readChecksum(const char *&data, const char *end);
+void checkBlock(const char *data, uint64_t length, uint32_t checksum);
+
+const char ARCHIVE_SIGNATURE[] = "HUF"; // first bytes of every archive file
+const char INDEX_SIGNATURE[] = "HUFI"; // last bytes of every archive file
+const char CONTAINER_SIGNATURE[] = "HUC"; // first bytes of every container of many files
+const char DIRECTORY_SIGNATURE[] = "HUFD"; // last bytes of every container of many files
+const int FORMAT_VERSION = 6; // version of the archive format, written after signature
+const int FOOTER_SIZE = 8 + 4; // offset of the block index and its signature
+const int CHECKSUM_SIZE = 4; // CRC32C of the source characters written before the payload of every block
+const int MAX_HEADER_SIZE = 16; // archive header is never longer
+const int MIN_RECORD_SIZE = 1 + 1 + CHECKSUM_SIZE + 1; // lengths of the block and the payload, checksum and method of the block
+const int BLOCKS_PER_THREAD = 2; // number of blocks coded at once for every thread
+const int STORED_SAVING = 32; // block is stored if coding could not make it smaller by this part of its size
+const int MAX_BLOCK_HEADER_SIZE = 2 + BYTES_NUMBER / 8 + BYTES_NUMBER; // method and code lengths of the block are never longer
+const int MAX_STREAMS_OVERHEAD = STREAMS_NUMBER * 11; // sizes of the streams and their last bytes in the interleaved block
+
+namespace {
+
+/* Class: AppendBuffer
+ * --------------------------------------------------------------
+ * Buffer of the output stream, which appends all written
+ * characters to the end of the array.
+ */
+class AppendBuffer : public streambuf{
+
+public:
+
+    explicit AppendBuffer(vector<uint8_t> &out) : out(out){
+    }
+
+protected:
+
+    int_type overflow(int_type ch){
+        if (ch != traits_type::eof()) out.push_back((uint8_t)ch);
+        return traits_type::not_eof(ch);
+    }
+
+    streamsize xsputn(const char *data, streamsize count){
+        out.insert(out.end(), (const uint8_t*)data, (const uint8_t*)data + count);
+        return count;
+    }
+
+private:
+
+    vector<uint8_t> &out;
+};
+
+/* Class: FilesReader
+ * --------------------------------------------------------------
+ * Reader of the files packed to the container. It reads files one
+ * after another to the blocks, every block has characters of only
+ * one file, and adds new member to the directory for every file.
+ */
+class FilesReader{
+
+public:
+
+    FilesReader(const vector<string> &filenames, vector<ArchiveMember> &members) :
+        filenames(filenames), members(members), nextFile(0){
+    }
+
+    /* Fills the blocks by the next parts of the files, number of the member
+     * of every block is saved to the array "owners". Returns number of the
+     * filled blocks, empty files are added to the members without blocks.*/
+    int readBlocks(vector<ArchiveBlock> &blocks, vector<size_t> &owners){
+        int count = 0;
+        while (count < (int)blocks.size()){
+            if (!in.is_open()){
+                if (nextFile == filenames.size()) break;
+                in.open(filenames[nextFile], ifstream::binary);
+                if (!in) throw runtime_error("Could not open " + filenames[nextFile]);
+                ArchiveMember member;
+                member.name = getMemberName(filenames[nextFile]);
+                if (member.name.empty()) throw runtime_error("Wrong name of the file " + filenames[nextFile]);
+                members.push_back(member);
+                nextFile++;
+            }
+            ArchiveBlock &block = blocks[count];
+            block.sourceBuffer.resize(BLOCK_SIZE);
+            in.read(block.sourceBuffer.data(), BLOCK_SIZE);
+            if (in.bad()) throw runtime_error("Could not read " + filenames[nextFile - 1]);
+            block.source = block.sourceBuffer.data();
+            block.sourceLength = in.gcount();
+            if (!in){
+                in.close();
+                in.clear();
+            }
+            if (block.sourceLength == 0) continue;
+            members.back().sourceLength += block.sourceLength;
+            owners[count] = members.size() - 1;
+            count++;
+        }
+        return count;
+    }
+
+private:
+
+    const vector<string> &filenames;
+    vector<ArchiveMember> &members;
+    size_t nextFile; // index of the file opened after the current one
+    ifstream in;
+};
+
+}
+
+Archiver::Archiver(const ArchiveOptions &options) : options(options), pool(options.threadsNumber),
+    tables(options.tablesDirectory){
+    if (options.maxCodeLength < MIN_CODE_LENGTH_LIMIT || options.maxCodeLength > DecodeTable::MAX_TABLE_CODE_LENGTH){
+        throw runtime_error("Maximal code length should be from " + to_string(MIN_CODE_LENGTH_LIMIT) + " to " +
+                            to_string(DecodeTable::MAX_TABLE_CODE_LENGTH) + " bits");
+    }
+    if (options.threadsNumber < 1) throw runtime_error("Number of threads should be at least 1");
+    blocks.resize(pool.size() * BLOCKS_PER_THREAD);
+}
+
+void Archiver::encode(const uint8_t *data, size_t length, vector<uint8_t> &out){
+    out.clear();
+    AppendBuffer buffer(out);
+    ostream stream(&buffer);
+    encodeArchive((const char*)data, length, stream);
+}
+
+void Archiver::decode(const uint8_t *data, size_t length, vector<uint8_t> &out){
+    ArchiveIndex index = readArchiveIndex((const char*)data, length);
+    out.resize(index.sourceLength);
+    decodeArchive((const char*)data, index, (char*)out.data());
+}
+
+/** Method: encodeStream
+ * Usage: archiver.encodeStream(cin, cout);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method codes data from the input stream, which could be not seekable, to the archive
+ * written to the output stream. Input is read by portions of the blocks coded in parallel, so
+ * only these blocks and the index of the written blocks are kept in the memory.
+ *
+ * @param in Input stream with the source data
+ * @param out Output stream for the archive
+ */
+void Archiver::encodeStream(istream &in, ostream &out){
+    uint64_t archiveSize = writeHeader(out, ARCHIVE_SIGNATURE);
+    written.clear();
+    int count;
+    while ((count = readBlocks(in, blocks)) > 0){
+        archiveSize += encodeBlocks(count, out);
+    }
+    if (in.bad()) throw runtime_error("Could not read the source data");
+    finishArchive(archiveSize, out);
+}
+
+/** Method: decodeStream
+ * Usage: archiver.decodeStream(cin, cout);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method decodes archive from the input stream, which could be not seekable, to the output
+ * stream. Blocks are read one after another until the end mark, by portions of BLOCKS_PER_THREAD
+ * blocks for every thread, decoded in parallel and written in the same order. Only these blocks are
+ * kept in the memory. At the end the index of the archive is checked against the read blocks.
+ *
+ * @param in Input stream with the archive
+ * @param out Output stream for the decoded data
+ */
+void Archiver::decodeStream(istream &in, ostream &out){
+    uint64_t archiveSize = 0;
+    uint64_t blockSize = readStreamHeader(in, archiveSize);
+
+    written.clear();
+    bool finished = false;
+    while (!finished){
+        int count = 0;
+        while (count < (int)blocks.size()){
+            uint64_t recordStart = archiveSize;
+            uint64_t length = readVarInt(in, archiveSize);
+            if (length == 0){
+                finished = true; // end of the blocks
+                break;
+            }
+            uint64_t payloadSize = readVarInt(in, archiveSize);
+            if (length > blockSize || payloadSize > length * MAX_CODE_LENGTH / 8 + MAX_BLOCK_HEADER_SIZE + MAX_STREAMS_OVERHEAD + 8){
+                throw runtime_error("Archive header is corrupted");
+            }
+
+            ArchiveBlock &block = blocks[count];
+            char checksum[CHECKSUM_SIZE];
+            in.read(checksum, CHECKSUM_SIZE);
+            if (in.gcount() != CHECKSUM_SIZE) throw runtime_error("Unexpected end of the archive");
+            const char *next = checksum;
+            block.checksum = readChecksum(next, checksum + CHECKSUM_SIZE);
+            block.body.resize(payloadSize);
+            in.read(block.body.data(), payloadSize);
+            if ((uint64_t)in.gcount() != payloadSize) throw runtime_error("Unexpected end of the archive");
+            archiveSize += CHECKSUM_SIZE + payloadSize;
+            block.sourceLength = length;
+            block.sourceBuffer.resize(length);
+
+            BlockInfo info;
+            info.recordSize = archiveSize - recordStart;
+            info.sourceLength = length;
+            written.push_back(info);
+            count++;
+        }
+
+        for (int i = 0; i < count; i++){
+            ArchiveBlock *block = &blocks[i];
+            pool.submit([this, block]{
+                decodePayload(block->body.data(), block->body.data() + block->body.size(),
+                              block->sourceBuffer.data(), block->sourceLength, tables);
+                checkBlock(block->sourceBuffer.data(), block->sourceLength, block->checksum);
+            });
+        }
+        pool.wait();
+
+        for (int i = 0; i < count; i++){
+            out.write(blocks[i].sourceBuffer.data(), blocks[i].sourceLength);
+        }
+        if (!out) throw runtime_error("Could not write the decoded data");
+    }
+
+    readStreamIndex(in, archiveSize, written);
+    out.flush();
+}
+
+/** Method: archiveFile
+ * Usage: archiver.archiveFile(sourceFileName, sourceFileName + ".huf");
+ * ------------------------------------------------------------------------------------
+ *
+ * This method maps the source file to the memory, so blocks are coded directly from the
+ * mapped file, and writes the archive to the output file.
+ *
+ * @param sourceName Name of the source file
+ * @param resultName Name of the output archive file
+ */
+void Archiver::archiveFile(const string &sourceName, const string &resultName){
+    MappedFile sourceFile;
+    sourceFile.openForReading(sourceName);
+
+    ofstream outFile(resultName, ofstream::binary);
+    if (!outFile) throw runtime_error("Could not write " + resultName);
+    encodeArchive(sourceFile.data(), sourceFile.size(), outFile);
+    outFile.close();
+    if (!outFile) throw runtime_error("Could not write " + resultName);
+}
+
+/** Method: dearchiveFile
+ * Usage: archiver.dearchiveFile(archiveName, "ORIGINAL_" + sourceName);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method maps both files to the memory, result file is created with the size of the
+ * source file read from the index of the archive. Every block is decoded directly from
+ * the archive to its own position in the result file.
+ *
+ * @param archiveName Name of the input archive file
+ * @param resultName Name of the output result file.
+ */
+void Archiver::dearchiveFile(const string &archiveName, const string &resultName){
+    MappedFile archiveFile;
+    archiveFile.openForReading(archiveName);
+    ArchiveIndex index = readArchiveIndex(archiveFile.data(), archiveFile.size());
+
+    MappedFile resultFile;
+    resultFile.create(resultName, index.sourceLength);
+    decodeArchive(archiveFile.data(), index, resultFile.data());
+    resultFile.close();
+}
+
+/** Method: extractRange
+ * Usage: archiver.extractRange(archiveName, rangeOffset, rangeLength, cout);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method writes received range of the source file from the archive to the output stream.
+ * It reads index of the blocks and finds first block of the range by binary search, then only
+ * blocks which contain bytes of the range are read and decoded. Range which goes after the end
+ * of the source file is shortened. Archive is mapped for random access, so pages of other blocks
+ * are not read ahead.
+ *
+ * @param archiveName Name of the input archive file
+ * @param offset First byte of the range in the source file.
+ * @param length Number of bytes in the range.
+ * @param out Output stream for the bytes of the range.
+ */
+void Archiver::extractRange(const string &archiveName, uint64_t offset, uint64_t length, ostream &out){
+    MappedFile archiveFile;
+    archiveFile.openForReading(archiveName, MappedFile::RANDOM_ACCESS);
+
+    ArchiveIndex index = readArchiveIndex(archiveFile.data(), archiveFile.size());
+    if (offset > index.sourceLength) throw runtime_error("Range is out of the file");
+    uint64_t rangeEnd = offset + min(length, index.sourceLength - offset);
+
+    /* First block which ends after the offset*/
+    size_t first = 0, last = index.blocks.size();
+    while (first < last){
+        size_t middle = (first + last) / 2;
+        const BlockInfo &info = index.blocks[middle];
+        if (info.sourceOffset + info.sourceLength <= offset){
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    for (size_t i = first; i < index.blocks.size() && index.blocks[i].sourceOffset < rangeEnd; i++){
+        const BlockInfo &info = index.blocks[i];
+        rangeBuffer.resize(info.sourceLength);
+        readBlock(archiveFile.data(), info, rangeBuffer.data(), tables);
+        uint64_t from = max(offset, info.sourceOffset) - info.sourceOffset;
+        uint64_t to = min(rangeEnd, info.sourceOffset + info.sourceLength) - info.sourceOffset;
+        out.write(rangeBuffer.data() + from, to - from);
+    }
+    out.flush();
+}
+
+/** Method: trainTable
+ * Usage: archiver.trainTable(corpusName, id);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method builds shared table from the whole sample file with the limit of the code length
+ * from the options and writes it to the directory of the shared tables.
+ *
+ * @param corpusName Name of the sample file
+ * @param id Number of the table, not 0
+ */
+void Archiver::trainTable(const string &corpusName, uint64_t id){
+    if (id == 0) throw runtime_error("Number of the shared table should not be 0");
+    MappedFile corpusFile;
+    corpusFile.openForReading(corpusName);
+
+    HuffmanCode codes[BYTES_NUMBER];
+    trainSharedTable(corpusFile.data(), corpusFile.size(), options.maxCodeLength, codes);
+    saveSharedTable(tables.getFilename(id), id, codes);
+}
+
+/** Method: packFiles
+ * Usage: archiver.packFiles(sourceNames, containerName);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method packs all received files and all files of the received directories to one
+ * container. Files are read one after another by portions of the blocks, so a portion could
+ * have blocks of many small files, and blocks of every portion are coded in parallel by the
+ * thread pool. Sizes of the written blocks are added to the sizes of their files, which are
+ * saved in the directory at the end of the container.
+ *
+ * @param sourceNames Names of the files and directories
+ * @param resultName Name of the output container file
+ */
+void Archiver::packFiles(const vector<string> &sourceNames, const string &resultName){
+    vector<string> filenames;
+    for (size_t i = 0; i < sourceNames.size(); i++){
+        listFiles(sourceNames[i], filenames);
+    }
+
+    ofstream outFile(resultName, ofstream::binary);
+    if (!outFile) throw runtime_error("Could not write " + resultName);
+    uint64_t archiveSize = writeHeader(outFile, CONTAINER_SIGNATURE);
+
+    vector<ArchiveMember> members;
+    vector<size_t> owners(blocks.size());
+    FilesReader reader(filenames, members);
+    int count;
+    while ((count = reader.readBlocks(blocks, owners)) > 0){
+        written.clear();
+        archiveSize += encodeBlocks(count, outFile);
+        for (int i = 0; i < count; i++){
+            members[owners[i]].archiveSize += written[i].recordSize;
+        }
+    }
+    writeDirectory(outFile, archiveSize, members);
+    outFile.close();
+    if (!outFile) throw runtime_error("Could not write " + resultName);
+}
+
+/** Method: listMembers
+ * Usage: vector<ArchiveMember> members = archiver.listMembers(containerName);
+ * ------------------------------------------------------------------------------------
+ *
+ * @param containerName Name of the container file
+ * @return Files of the container in the packed order
+ */
+vector<ArchiveMember> Archiver::listMembers(const string &containerName){
+    MappedFile containerFile;
+    containerFile.openForReading(containerName);
+    uint64_t blockSize;
+    return readDirectory(containerFile.data(), containerFile.size(), blockSize);
+}
+
+/** Method: extractMember
+ * Usage: archiver.extractMember(containerName, memberName, cout);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method finds the file in the directory of the container and walks only its own blocks,
+ * blocks of other files are never read, so the container is mapped for random access. Blocks are
+ * decoded in parallel by portions and written to the output stream in the same order.
+ *
+ * @param containerName Name of the container file
+ * @param memberName Name of the file in the container
+ * @param out Output stream for the content of the file
+ */
+void Archiver::extractMember(const string &containerName, const string &memberName, ostream &out){
+    MappedFile containerFile;
+    containerFile.openForReading(containerName, MappedFile::RANDOM_ACCESS);
+    uint64_t blockSize;
+    vector<ArchiveMember> members = readDirectory(containerFile.data(), containerFile.size(), blockSize);
+
+    size_t member = 0;
+    while (member < members.size() && members[member].name != memberName) member++;
+    if (member == members.size()) throw runtime_error("File " + memberName + " is not found in the container");
+
+    ArchiveIndex index = readMemberIndex(containerFile.data(), blockSize, members[member]);
+    for (size_t first = 0; first < index.blocks.size(); first += blocks.size()){
+        int count = min(blocks.size(), index.blocks.size() - first);
+        decodeBlocks(containerFile.data(), index.blocks.data() + first, count);
+        for (int i = 0; i < count; i++){
+            out.write(blocks[i].sourceBuffer.data(), blocks[i].sourceLength);
+        }
+        if (!out) throw runtime_error("Could not write the decoded data");
+    }
+    out.flush();
+}
+
+/** Method: unpackFiles
+ * Usage: archiver.unpackFiles(containerName, directory);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method restores all files of the container in the received directory, subdirectories
+ * of the files are created. Blocks of all files are decoded by portions in parallel, so small
+ * files are decoded together, and then written to their files in the packed order. Names which
+ * could lead out of the directory are not allowed.
+ *
+ * @param containerName Name of the container file
+ * @param directory Directory for the restored files
+ */
+void Archiver::unpackFiles(const string &containerName, const string &directory){
+    MappedFile containerFile;
+    containerFile.openForReading(containerName);
+    uint64_t blockSize;
+    vector<ArchiveMember> members = readDirectory(containerFile.data(), containerFile.size(), blockSize);
+
+    /* Blocks of all files and numbers of their files*/
+    vector<BlockInfo> infos;
+    vector<size_t> owners;
+    for (size_t i = 0; i < members.size(); i++){
+        if (!isSafeMemberName(members[i].name)) throw runtime_error("Wrong name of the file " + members[i].name);
+        ArchiveIndex index = readMemberIndex(containerFile.data(), blockSize, members[i]);
+        infos.insert(infos.end(), index.blocks.begin(), index.blocks.end());
+        owners.insert(owners.end(), index.blocks.size(), i);
+    }
+
+    ofstream out;
+    size_t created = 0; // number of the created files
+    for (size_t first = 0; first < infos.size(); first += blocks.size()){
+        int count = min(blocks.size(), infos.size() - first);
+        decodeBlocks(containerFile.data(), infos.data() + first, count);
+        for (int i = 0; i < count; i++){
+            while (created <= owners[first + i]){
+                openMemberFile(out, directory + "/" + members[created++].name);
+            }
+            out.write(blocks[i].sourceBuffer.data(), blocks[i].sourceLength);
+        }
+    }
+    while (created < members.size()){
+        openMemberFile(out, directory + "/" + members[created++].name);
+    }
+    out.close();
+    if (!out) throw runtime_error("Could not write the decoded data");
+}
+
+/** Method: verifyFile
+ * Usage: uint64_t length = archiver.verifyFile(archiveName);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method checks the archive or the container without writing anything. Blocks are decoded
+ * by portions in parallel to the same buffers of the portion, which are reused by every next
+ * portion, checksum of every block is checked while it is decoded. Every block is decoded exactly
+ * to its length from the index, and lengths of the blocks are already checked to sum up to the
+ * length of the source data while the index is read.
+ *
+ * @param archiveName Name of the archive or container file
+ * @return Number of the checked characters of the source data
+ */
+uint64_t Archiver::verifyFile(const string &archiveName){
+    MappedFile archiveFile;
+    archiveFile.openForReading(archiveName);
+
+    vector<BlockInfo> infos;
+    uint64_t sourceLength = 0;
+    if (archiveFile.size() >= sizeof(CONTAINER_SIGNATURE) &&
+            string(archiveFile.data(), sizeof(CONTAINER_SIGNATURE) - 1) == CONTAINER_SIGNATURE){
+        uint64_t blockSize;
+        vector<ArchiveMember> members = readDirectory(archiveFile.data(), archiveFile.size(), blockSize);
+        for (size_t i = 0; i < members.size(); i++){
+            ArchiveIndex index = readMemberIndex(archiveFile.data(), blockSize, members[i]);
+            infos.insert(infos.end(), index.blocks.begin(), index.blocks.end());
+            sourceLength += members[i].sourceLength;
+        }
+    } else {
+        ArchiveIndex index = readArchiveIndex(archiveFile.data(), archiveFile.size());
+        infos.swap(index.blocks);
+        sourceLength = index.sourceLength;
+    }
+
+    for (size_t first = 0; first < infos.size(); first += blocks.size()){
+        int count = min(blocks.size(), infos.size() - first);
+        decodeBlocks(archiveFile.data(), infos.data() + first, count);
+    }
+    return sourceLength;
+}
+
+//-----------------------Encoding------------------------------------------------------
+/** Method: encodeArchive
+ * Usage: encodeArchive(data, length, out);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method implements encoding using Huffman's algoritm.
+ * Source data is divided into blocks of BLOCK_SIZE characters, every block is coded
+ * independently with its own table by encodeBlock. Blocks are taken by portions
+ * of BLOCKS_PER_THREAD blocks for every thread and coded in parallel by the thread pool.
+ * Coded blocks are written to the archive in the same order as they are placed in the source.
+ * Position in the archive is counted by written bytes, so output stream is never seeked.
+ *
+ * @param data Source data
+ * @param length Number of the source characters
+ * @param out Output stream for the archive
+ */
+void Archiver::encodeArchive(const char *data, uint64_t length, ostream &out){
+    uint64_t archiveSize = writeHeader(out, ARCHIVE_SIGNATURE);
+    written.clear();
+    uint64_t position = 0;
+    int count;
+    while ((count = nextBlocks(data, length, position, blocks)) > 0){
+        archiveSize += encodeBlocks(count, out);
+    }
+    finishArchive(archiveSize, out);
+}
+
+/** Method: encodeBlocks
+ * Usage: archiveSize += encodeBlocks(count, out);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method codes first blocks of the portion in parallel by the thread pool and writes them
+ * to the archive in the same order. Sizes of the written blocks are added to the index.
+ *
+ * @param count Number of the filled blocks of the portion
+ * @param out Output stream for the archive
+ * @return Number of bytes written to the archive
+ */
+uint64_t Archiver::encodeBlocks(int count, ostream &out){
+    shared_ptr<const SharedTable> sharedTable;
+    if (options.sharedTable != 0) sharedTable = tables.get(options.sharedTable);
+    for (int i = 0; i < count; i++){
+        ArchiveBlock *block = &blocks[i];
+        const SharedTable *table = sharedTable.get();
+        pool.submit([this, block, table]{ encodeBlock(*block, options, table); });
+    }
+    pool.wait();
+
+    uint64_t size = 0;
+    for (int i = 0; i < count; i++){
+        BlockInfo info;
+        info.recordSize = writeBlock(out, blocks[i]);
+        info.sourceLength = blocks[i].sourceLength;
+        size += info.recordSize;
+        written.push_back(info);
+    }
+    return size;
+}
+
+/** Method: finishArchive
+ * Usage: finishArchive(archiveSize, out);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method writes the end mark of the blocks and the index of the written blocks.
+ *
+ * @param archiveSize Number of bytes written to the archive before the end mark
+ * @param out Output stream for the archive
+ */
+void Archiver::finishArchive(uint64_t archiveSize, ostream &out){
+    archiveSize += writeVarInt(out, 0); // end of the blocks
+    writeIndex(out, archiveSize, written);
+    out.flush();
+    if (!out) throw runtime_error("Could not write the archive");
+}
+
+/** Function: nextBlocks
+ * Usage: int count = nextBlocks(data, length, position, blocks);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function points blocks of the received array to the next parts of the source data,
+ * one block for every element of the array. Only last block could be shorter then BLOCK_SIZE.
+ *
+ * @param data Source data.
+ * @param length Number of the source characters.
+ * @param position Position of the next block in the data, moved after the taken blocks.
+ * @param blocks Array of the blocks to fill
+ * @return number of the taken blocks
+ */
+int nextBlocks(const char *data, uint64_t length, uint64_t &position, vector<ArchiveBlock> &blocks){
+    int count = 0;
+    while (count < (int)blocks.size() && position < length){
+        ArchiveBlock &block = blocks[count];
+        block.source = data + position;
+        block.sourceLength = min((uint64_t)BLOCK_SIZE, length - position);
+        position += block.sourceLength;
+        count++;
+    }
+    return count;
+}
+
+/** Function: readBlocks
+ * Usage: int count = readBlocks(in, blocks);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function reads next blocks of the input stream to the buffers of the blocks, one block
+ * for every element of the received array. Only last block could be shorter then BLOCK_SIZE.
+ *
+ * @param in Input stream.
+ * @param blocks Array of the blocks to fill
+ * @return number of the read blocks
+ */
+int readBlocks(istream &in, vector<ArchiveBlock> &blocks){
+    int count = 0;
+    while (count < (int)blocks.size() && in){
+        ArchiveBlock &block = blocks[count];
+        block.sourceBuffer.resize(BLOCK_SIZE);
+        in.read(block.sourceBuffer.data(), BLOCK_SIZE);
+        block.source = block.sourceBuffer.data();
+        block.sourceLength = in.gcount();
+        if (block.sourceLength == 0) break;
+        count++;
+    }
+    return count;
+}
+
+/** Function: encodeBlock
+ * Usage: encodeBlock(block, options, sharedTable);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function codes one block of the source data. Block of the only repeated character keeps
+ * just this character. In adaptive mode the block is coded in one pass and only the limit of the
+ * code length is stored before the body. Block coded by the shared table stores only number of
+ * the table, its codes are already built. In the context mode tables of the previous characters are
+ * stored, if this makes the block smaller. Otherwise block is coded by its own Huffman's codes.
+ * Entropy of the frequencies is not a bound for the shared, adaptive and order-1 codes, so these
+ * blocks are coded first and replaced by the stored one if they are larger then the source.
+ *
+ * @param block Block with filled source characters
+ * @param options Options of the archivation
+ * @param sharedTable Shared table for coding the block or nullptr
+ */
+void encodeBlock(ArchiveBlock &block, const ArchiveOptions &options, const SharedTable *sharedTable){
+    block.checksum = crc32c(block.source, block.sourceLength);
+    block.body.clear();
+    if (isRun(block.source, block.sourceLength)){
+        block.header = string(1, (char)RUN_BLOCK) + block.source[0];
+        return;
+    }
+
+    if (sharedTable != nullptr){
+        block.header = string(1, (char)SHARED_TABLE_BLOCK);
+        appendVarInt(block.header, sharedTable->id);
+        encodeBody(block.source, block.sourceLength, sharedTable->codes, block.body);
+    } else if (options.adaptive){
+        block.header = string(1, (char)ADAPTIVE_BLOCK) + (char)options.maxCodeLength;
+        encodeAdaptive(block.source, block.sourceLength, options.maxCodeLength, block.body);
+    } else if (options.contextModel && encodeContext(block.source, block.sourceLength, options.maxCodeLength, block.header, block.body)){
+        block.header.insert(0, 1, (char)CONTEXT_BLOCK);
+    } else {
+        encodeHuffmanBlock(block, options);
+    }
+
+    if (block.header.size() + block.body.size() > block.sourceLength) storeBlock(block);
+}
+
+/** Function: encodeHuffmanBlock
+ * Usage: encodeHuffmanBlock(block, options);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function codes one block by its own table. At the beginning it builds an alphabet of the
+ * characters and their frequency of use in the block, counted exactly or estimated by the sample.
+ * If even the order-0 entropy of these frequencies does not make the block smaller by
+ * 1/STORED_SAVING, block is stored without building the codes. Otherwise it finds canonical codes
+ * for characters by Huffman's algorithm, less bits for commonly used characters, no code is longer
+ * then allowed by options. After this it packs new codes of all characters of the block. Interleaved
+ * block has sizes of its streams after the code lengths.
+ *
+ * @param block Block with filled source characters
+ * @param options Options of the archivation
+ */
+void encodeHuffmanBlock(ArchiveBlock &block, const ArchiveOptions &options){
+
+    /* Alphabet with all characters used in the block and their frequencies */
+    uint64_t alphabet[BYTES_NUMBER];
+    if (options.sampled){
+        getSampledAlphabet(block.source, block.sourceLength, alphabet);
+    } else {
+        getAlphabet(block.source, block.sourceLength, alphabet);
+    }
+    if (estimateCodedSize(alphabet, block.sourceLength) + block.sourceLength / STORED_SAVING >= block.sourceLength){
+        storeBlock(block);
+        return;
+    }
+
+    /* Table for coding characters saved in the array "table" */
+    HuffmanCode table[BYTES_NUMBER];
+    buildCodes(alphabet, options.maxCodeLength, table);
+
+    /* Lengths of the new codes stored in binary format for subsequent writing to the archive file*/
+    block.header = string(1, (char)(options.interleaved ? INTERLEAVED_BLOCK : HUFFMAN_BLOCK)) + getCodeLengthsForFile(table);
+
+    if (options.interleaved){
+        /* Size of the last stream is known from the size of the payload*/
+        uint64_t streamSizes[STREAMS_NUMBER];
+        encodeStreams(block.source, block.sourceLength, table, streamSizes, block.body);
+        for (int i = 0; i < STREAMS_NUMBER - 1; i++){
+            appendVarInt(block.header, streamSizes[i]);
+        }
+        return;
+    }
+
+    /* Code all characters according to coding table*/
+    encodeBody(block.source, block.sourceLength, table, block.body);
+}
+
+/** Function: storeBlock
+ * Usage: storeBlock(block);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function replaces coded block by the source characters, which are copied to the body.
+ *
+ * @param block Block with filled source characters
+ */
+void storeBlock(ArchiveBlock &block){
+    block.header = string(1, (char)STORED_BLOCK);
+    block.body.assign(block.source, block.source + block.sourceLength);
+}
+
+/** Function: isRun
+ * Usage: if (isRun(block.source, block.sourceLength))...
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function compares characters with the first one until the first difference, so other
+ * blocks are rejected at once.
+ *
+ * @param data Array of the characters
+ * @param length Number of the characters, not 0
+ * @return true if all characters are the same
+ */
+bool isRun(const char *data, size_t length){
+    size_t i = 1;
+    while (i < length && data[i] == data[0]) i++;
+    return i == length;
+}
+
+/** Function: writeHeader
+ * Usage:  uint64_t archiveSize = writeHeader(out, ARCHIVE_SIGNATURE);
+ * ------------------------------------------------------------------------------------------
+ *
+ * This function writes signature, version of the format and size of the block.
+ *
+ * @param out Output archive stream.
+ * @param signature Signature of the archive or of the container.
+ * @return Number of bytes written to the archive.
+ */
+uint64_t writeHeader(ostream &out, const char *signature){
+    out << signature << (char)FORMAT_VERSION;
+    return sizeof(ARCHIVE_SIGNATURE) + writeVarInt(out, BLOCK_SIZE);
+}
+
+/** Function: writeBlock
+ * Usage:  uint64_t recordSize = writeBlock(out, block);
+ * ------------------------------------------------------------------------------------------
+ *
+ * This function writes coded block to the output archive. At the begining of the block
+ * placed number of characters of the block, size of the payload in bytes and checksum of the
+ * source characters, after this the payload: method of coding with code lengths for decoding
+ * block and the coded body itself.
+ *
+ * @param out Output archive stream.
+ * @param block Coded block.
+ * @return Number of bytes written to the archive.
+ */
+uint64_t writeBlock(ostream &out, const ArchiveBlock &block){
+    uint64_t payloadSize = block.header.size() + block.body.size();
+    uint64_t headerSize = writeVarInt(out, block.sourceLength);
+    headerSize += writeVarInt(out, payloadSize);
+    for (int i = 0; i < CHECKSUM_SIZE; i++){
+        out.put((char)(block.checksum >> (8 * i)));
+    }
+    headerSize += CHECKSUM_SIZE;
+    out << block.header;
+    out.write(block.body.data(), block.body.size());
+    return headerSize + payloadSize;
+}
+
+/** Function: writeIndex
+ * Usage:  writeIndex(out, indexOffset, written);
+ * ------------------------------------------------------------------------------------------
+ *
+ * This function writes index of the blocks after the end of the blocks. Index contains
+ * number of the blocks and then size in the archive and number of characters of every block.
+ * The last bytes of the archive are offset of the index in eight bytes, lowest byte goes first,
+ * and INDEX_SIGNATURE, so the index could be found from the end of the archive.
+ *
+ * @param out Output archive stream.
+ * @param indexOffset Number of bytes written to the archive before the index.
+ * @param blocks Sizes of the written blocks.
+ */
+void writeIndex(ostream &out, uint64_t indexOffset, const vector<BlockInfo> &blocks){
+    writeVarInt(out, blocks.size());
+    for (size_t i = 0; i < blocks.size(); i++){
+        writeVarInt(out, blocks[i].recordSize);
+        writeVarInt(out, blocks[i].sourceLength);
+    }
+    writeOffset(out, indexOffset, INDEX_SIGNATURE);
+}
+
+/** Function: writeDirectory
+ * Usage:  writeDirectory(out, directoryOffset, members);
+ * ------------------------------------------------------------------------------------------
+ *
+ * This function writes directory of the container after the blocks of all files. Directory
+ * contains number of the files and then length and characters of the name, number of characters
+ * and size of the blocks in the container of every file. Blocks of the files go in the same order,
+ * so offset of every file is found as the sum of the sizes of the previous files. The last bytes
+ * of the container are offset of the directory and DIRECTORY_SIGNATURE.
+ *
+ * @param out Output container stream.
+ * @param directoryOffset Number of bytes written to the container before the directory.
+ * @param members Files of the container.
+ */
+void writeDirectory(ostream &out, uint64_t directoryOffset, const vector<ArchiveMember> &members){
+    writeVarInt(out, members.size());
+    for (size_t i = 0; i < members.size(); i++){
+        writeVarInt(out, members[i].name.length());
+        out << members[i].name;
+        writeVarInt(out, members[i].sourceLength);
+        writeVarInt(out, members[i].archiveSize);
+    }
+    writeOffset(out, directoryOffset, DIRECTORY_SIGNATURE);
+}
+
+/** Function: writeOffset
+ * Usage:  writeOffset(out, indexOffset, INDEX_SIGNATURE);
+ * ------------------------------------------------------------------------------------------
+ *
+ * This function writes footer of the archive: offset in eight bytes, lowest byte goes first,
+ * and the signature.
+ *
+ * @param out Output archive stream.
+ * @param offset Offset of the index.
+ * @param signature Signature of the index.
+ */
+void writeOffset(ostream &out, uint64_t offset, const char *signature){
+    for (int i = 0; i < 8; i++){
+        out.put((char)(offset >> (8 * i)));
+    }
+    out << signature;
+}
+
+/**
+ * Function: writeVarInt
+ * Usage: writeVarInt(out, block.sourceLength);
+ * ----------------------------------------------------------------------------
+ *
+ * This function writes received number to the stream by groups of seven bits,
+ * lowest group goes first. Highest bit of the byte is set if more groups follow,
+ * so small numbers take only one byte.
+ *
+ * @param out Output stream
+ * @param value Number to write
+ * @return Number of the written bytes
+ */
+int writeVarInt(ostream &out, uint64_t value){
+    int size = 1;
+    while (value >= 0x80){
+        out.put((char)(value | 0x80));
+        value >>= 7;
+        size++;
+    }
+    out.put((char)value);
+    return size;
+}
+
+/** Function: appendVarInt
+ * Usage: appendVarInt(block.header, sharedTable->id);
+ * ----------------------------------------------------------------------------
+ *
+ * This function appends received number to the string in the same format as writeVarInt.
+ *
+ * @param out String for the number
+ * @param value Number to write
+ */
+void appendVarInt(string &out, uint64_t value){
+    while (value >= 0x80){
+        out += (char)(value | 0x80);
+        value >>= 7;
+    }
+    out += (char)value;
+}
+
+//------------------------Decoding-----------------------------------------------------
+
+/** Method: decodeArchive
+ * Usage: decodeArchive(archive, index, out);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method decodes the archive, which index is already read, so position of every block
+ * in the archive and in the source data is known. Blocks are decoded by the thread pool
+ * independently from each other, every block is decoded to its own position in the output.
+ *
+ * @param archive Archive data
+ * @param index Index of the blocks
+ * @param out Buffer for the decoded data of the source length
+ */
+void Archiver::decodeArchive(const char *archive, const ArchiveIndex &index, char *out){
+    for (size_t i = 0; i < index.blocks.size(); i++){
+        const BlockInfo *info = &index.blocks[i];
+        char *blockOut = out + info->sourceOffset;
+        pool.submit([this, archive, info, blockOut]{ readBlock(archive, *info, blockOut, tables); });
+    }
+    pool.wait();
+}
+
+/** Method: decodeBlocks
+ * Usage: decodeBlocks(archive, infos, count);
+ * ------------------------------------------------------------------------------------
+ *
+ * This method decodes received blocks in parallel to the buffers of the blocks of the portion,
+ * one block of the portion for every block of the archive.
+ *
+ * @param archive Archive data
+ * @param infos Positions of the blocks
+ * @param count Number of the blocks, not more then size of the portion
+ */
+void Archiver::decodeBlocks(const char *archive, const BlockInfo *infos, int count){
+    for (int i = 0; i < count; i++){
+        ArchiveBlock *block = &blocks[i];
+        const BlockInfo *info = &infos[i];
+        block->sourceLength = info->sourceLength;
+        block->sourceBuffer.resize(info->sourceLength);
+        pool.submit([this, archive, info, block]{ readBlock(archive, *info, block->sourceBuffer.data(), tables); });
+    }
+    pool.wait();
+}
+
+/**
+ * Function: readArchiveIndex
+ * Usage: ArchiveIndex index = readArchiveIndex(archive, size);
+ * --------------------------------------------------------------------------------
+ *
+ * This function checks signature and version of the archive format and read size of the
+ * block writed after them. Then it finds index of the blocks by offset stored at the end of
+ * the archive and calculates position of every block in the archive and in the source data.
+ * Every block should take at least MIN_RECORD_SIZE bytes and all of them should fit before
+ * the index, so the length of the source data is checked before it is allocated.
+ *
+ * @param archive Archive data.
+ * @param size Size of the archive.
+ * @return Index of the blocks.
+ */
+ArchiveIndex readArchiveIndex(const char *archive, uint64_t size){
+    ArchiveIndex index;
+    uint64_t blockSize;
+    uint64_t blocksStart = readHeader(archive, size, ARCHIVE_SIGNATURE, blockSize);
+    index.blockSize = blockSize;
+    uint64_t indexOffset = readOffset(archive, size, INDEX_SIGNATURE);
+    if (indexOffset < blocksStart + 1) throw runtime_error("Archive index is corrupted");
+
+    /* Index*/
+    const char *next = archive + indexOffset;
+    const char *end = archive + size - FOOTER_SIZE;
+    uint64_t count = readVarInt(next, end);
+    if (count > (uint64_t)(end - next) || count > (indexOffset - blocksStart) / MIN_RECORD_SIZE){
+        throw runtime_error("Archive index is corrupted");
+    }
+
+    uint64_t archiveOffset = blocksStart;
+    for (uint64_t i = 0; i < count; i++){
+        BlockInfo info;
+        info.archiveOffset = archiveOffset;
+        info.recordSize = readVarInt(next, end);
+        info.sourceOffset = index.sourceLength;
+        info.sourceLength = readVarInt(next, end);
+        if (info.sourceLength == 0 || info.sourceLength > blockSize || info.recordSize < MIN_RECORD_SIZE ||
+                info.recordSize >= indexOffset - archiveOffset){
+            throw runtime_error("Archive index is corrupted");
+        }
+        archiveOffset += info.recordSize;
+        index.sourceLength += info.sourceLength;
+        index.blocks.push_back(info);
+    }
+    if (archiveOffset + 1 != indexOffset) throw runtime_error("Archive index is corrupted"); // one byte of the end mark
+    return index;
+}
+
+/**
+ * Function: readHeader
+ * Usage: uint64_t blocksStart = readHeader(archive, size, ARCHIVE_SIGNATURE, blockSize);
+ * --------------------------------------------------------------------------------
+ *
+ * This function checks signature and version of the archive format and reads size of the
+ * block writed after them.
+ *
+ * @param archive Archive data.
+ * @param size Size of the archive.
+ * @param signature Expected signature of the archive.
+ * @param blockSize Variable for the size of the block.
+ * @return Offset of the first block.
+ */
+uint64_t readHeader(const char *archive, uint64_t size, const char *signature, uint64_t &blockSize){
+    if (size < sizeof(ARCHIVE_SIGNATURE) + FOOTER_SIZE) throw runtime_error("File is not Huffman archive");
+    int headerSize = min((uint64_t)MAX_HEADER_SIZE, size);
+    if (string(archive, sizeof(ARCHIVE_SIGNATURE) - 1) != signature){
+        throw runtime_error("File is not Huffman archive");
+    }
+    if (archive[sizeof(ARCHIVE_SIGNATURE) - 1] != FORMAT_VERSION){
+        throw runtime_error("Unsupported version of the archive format");
+    }
+    const char *next = archive + sizeof(ARCHIVE_SIGNATURE);
+    blockSize = readVarInt(next, archive + headerSize);
+    if (blockSize == 0 || blockSize > (uint64_t)BLOCK_SIZE) throw runtime_error("Archive header is corrupted");
+    return next - archive;
+}
+
+/**
+ * Function: readOffset
+ * Usage: uint64_t indexOffset = readOffset(archive, size, INDEX_SIGNATURE);
+ * --------------------------------------------------------------------------------
+ *
+ * This function checks signature at the end of the archive and reads offset of the index
+ * before it.
+ *
+ * @param archive Archive data.
+ * @param size Size of the archive, not less then FOOTER_SIZE.
+ * @param signature Expected signature of the index.
+ * @return Offset of the index, which is placed before the footer.
+ */
+uint64_t readOffset(const char *archive, uint64_t size, const char *signature){
+    const char *footer = archive + size - FOOTER_SIZE;
+    if (string(footer + 8, FOOTER_SIZE - 8) != signature) throw runtime_error("Archive index is not found");
+    uint64_t offset = 0;
+    for (int i = 0; i < 8; i++){
+        offset |= (uint64_t)(unsigned char)footer[i] << (8 * i);
+    }
+    if (offset > size - FOOTER_SIZE) throw runtime_error("Archive index is corrupted");
+    return offset;
+}
+
+/**
+ * Function: readDirectory
+ * Usage: vector<ArchiveMember> members = readDirectory(container, size, blockSize);
+ * --------------------------------------------------------------------------------
+ *
+ * This function checks header of the container and reads its directory. Position of the blocks
+ * of every file is calculated from the sizes of the previous files.
+ *
+ * @param archive Container data.
+ * @param size Size of the container.
+ * @param blockSize Variable for the size of the block.
+ * @return Files of the container.
+ */
+vector<ArchiveMember> readDirectory(const char *archive, uint64_t size, uint64_t &blockSize){
+    uint64_t blocksStart = readHeader(archive, size, CONTAINER_SIGNATURE, blockSize);
+    uint64_t directoryOffset = readOffset(archive, size, DIRECTORY_SIGNATURE);
+    if (directoryOffset < blocksStart) throw runtime_error("Archive index is corrupted");
+
+    const char *next = archive + directoryOffset;
+    const char *end = archive + size - FOOTER_SIZE;
+    uint64_t count = readVarInt(next, end);
+    if (count > (uint64_t)(end - next)) throw runtime_error("Archive index is corrupted");
+
+    vector<ArchiveMember> members(count);
+    uint64_t archiveOffset = blocksStart;
+    for (uint64_t i = 0; i < count; i++){
+        ArchiveMember &member = members[i];
+        uint64_t nameLength = readVarInt(next, end);
+        if (nameLength > (uint64_t)(end - next)) throw runtime_error("Archive index is corrupted");
+        member.name.assign(next, nameLength);
+        next += nameLength;
+        member.sourceLength = readVarInt(next, end);
+        member.archiveSize = readVarInt(next, end);
+        member.archiveOffset = archiveOffset;
+        if (member.archiveSize > directoryOffset - archiveOffset) throw runtime_error("Archive index is corrupted");
+        archiveOffset += member.archiveSize;
+    }
+    if (archiveOffset != directoryOffset || next != end) throw runtime_error("Archive index is corrupted");
+    return members;
+}
+
+/**
+ * Function: readMemberIndex
+ * Usage: ArchiveIndex index = readMemberIndex(container, blockSize, member);
+ * --------------------------------------------------------------------------------
+ *
+ * This function walks headers of the blocks of one file in the container and calculates
+ * position of every block in the container and in the file. Bodies of the blocks are skipped.
+ *
+ * @param archive Container data.
+ * @param blockSize Size of the block.
+ * @param member File of the container read from the directory.
+ * @return Index of the blocks of the file.
+ */
+ArchiveIndex readMemberIndex(const char *archive, uint64_t blockSize, const ArchiveMember &member){
+    ArchiveIndex index;
+    index.blockSize = blockSize;
+    const char *next = archive + member.archiveOffset;
+    const char *end = next + member.archiveSize;
+    while (next < end){
+        BlockInfo info;
+        info.archiveOffset = next - archive;
+        info.sourceOffset = index.sourceLength;
+        info.sourceLength = readVarInt(next, end);
+        uint64_t payloadSize = readVarInt(next, end);
+        if (info.sourceLength == 0 || info.sourceLength > blockSize || (uint64_t)(end - next) < CHECKSUM_SIZE ||
+                payloadSize > (uint64_t)(end - next) - CHECKSUM_SIZE){
+            throw runtime_error("Archive header is corrupted");
+        }
+        next += CHECKSUM_SIZE + payloadSize;
+        info.recordSize = (next - archive) - info.archiveOffset;
+        index.sourceLength += info.sourceLength;
+        index.blocks.push_back(info);
+    }
+    if (index.sourceLength != member.sourceLength) throw runtime_error("Archive index is corrupted");
+    return index;
+}
+
+/**
+ * Function: readStreamHeader
+ * Usage: uint64_t blockSize = readStreamHeader(in, archiveSize);
+ * --------------------------------------------------------------------------------
+ *
+ * This function checks signature and version of the archive read from the stream
+ * and reads size of the block.
+ *
+ * @param in Input stream with the archive.
+ * @param archiveSize Number of bytes read from the archive, increased by the header size.
+ * @return Size of the block.
+ */
+uint64_t readStreamHeader(istream &in, uint64_t &archiveSize){
+    char header[sizeof(ARCHIVE_SIGNATURE)];
+    in.read(header, sizeof(header));
+    if (in.gcount() != (streamsize)sizeof(header) || string(header, sizeof(header) - 1) != ARCHIVE_SIGNATURE){
+        throw runtime_error("File is not Huffman archive");
+    }
+    if (header[sizeof(header) - 1] != FORMAT_VERSION){
+        throw runtime_error("Unsupported version of the archive format");
+    }
+    archiveSize += sizeof(header);
+    uint64_t blockSize = readVarInt(in, archiveSize);
+    if (blockSize == 0 || blockSize > (uint64_t)BLOCK_SIZE) throw runtime_error("Archive header is corrupted");
+    return blockSize;
+}
+
+/**
+ * Function: readStreamIndex
+ * Usage: readStreamIndex(in, archiveSize, written);
+ * --------------------------------------------------------------------------------
+ *
+ * This function reads index of the blocks after the end mark from the stream and checks
+ * that it describes the same blocks, which were read before, and that the archive ends
+ * right after the footer.
+ *
+ * @param in Input stream with the archive.
+ * @param indexOffset Number of bytes read from the archive before the index.
+ * @param blocks Sizes of the read blocks.
+ */
+void readStreamIndex(istream &in, uint64_t indexOffset, const vector<BlockInfo> &blocks){
+    uint64_t indexSize = 0;
+    if (readVarInt(in, indexSize) != blocks.size()) throw runtime_error("Archive index is corrupted");
+    for (size_t i = 0; i < blocks.size(); i++){
+        if (readVarInt(in, indexSize) != blocks[i].recordSize || readVarInt(in, indexSize) != blocks[i].sourceLength){
+            throw runtime_error("Archive index is corrupted");
+        }
+    }
+
+    char footer[FOOTER_SIZE];
+    in.read(footer, FOOTER_SIZE);
+    if (in.gcount() != FOOTER_SIZE || string(footer + 8, FOOTER_SIZE - 8) != INDEX_SIGNATURE){
+        throw runtime_error("Archive index is not found");
+    }
+    uint64_t offset = 0;
+    for (int i = 0; i < 8; i++){
+        offset |= (uint64_t)(unsigned char)footer[i] << (8 * i);
+    }
+    if (offset != indexOffset || in.peek() != istream::traits_type::eof()){
+        throw runtime_error("Archive index is corrupted");
+    }
+}
+
+/**
+ * Function: readBlock
+ * Usage: readBlock(archive, info, buffer, tables);
+ * --------------------------------------------------------------------------------
+ *
+ * This function reads one block from the archive, checks its header against the index,
+ * read code lengths and restores canonical codes from them and decodes body of the block
+ * to the received buffer. Decoded characters are checked by the checksum of the block.
+ * Blocks could be read by several threads at once.
+ *
+ * @param archive Archive data.
+ * @param info Position of the block.
+ * @param out Buffer for the decoded characters, not less then the length of the block.
+ * @param tables Cache of the shared tables.
+ */
+void readBlock(const char *archive, const BlockInfo &info, char *out, SharedTableCache &tables){
+    const char *next = archive + info.archiveOffset;
+    const char *end = next + info.recordSize;
+
+    /* Reading length of the block */
+    uint64_t length = readVarInt(next, end);
+    uint64_t payloadSize = readVarInt(next, end);
+    uint32_t checksum = readChecksum(next, end);
+    if (length != info.sourceLength || payloadSize != (uint64_t)(end - next)){
+        throw runtime_error("Archive header is corrupted");
+    }
+
+    decodePayload(next, end, out, length, tables);
+    checkBlock(out, length, checksum);
+}
+
+/**
+ * Function: decodePayload
+ * Usage: decodePayload(next, end, buffer, length, tables);
+ * --------------------------------------------------------------------------------
+ *
+ * This function reads method of coding the block. For Huffman's block it read code lengths
+ * and restores canonical codes from them, adaptive block has only limit of the code length and
+ * block coded by the shared table has only number of the table loaded by the cache. Block coded by
+ * the contexts has tables of the previous characters. Interleaved block has sizes of its streams
+ * after the code lengths. Stored block is copied and run block is filled by its only character.
+ * Then it decodes body of the block to the received buffer.
+ *
+ * @param payload Method, code lengths and body of the block.
+ * @param end End of the payload.
+ * @param out Buffer for the decoded characters, not less then the length of the block.
+ * @param length Number of the characters in the block.
+ * @param tables Cache of the shared tables.
+ */
+void decodePayload(const char *payload, const char *end, char *out, uint64_t length, SharedTableCache &tables){
+    int method = readByte(payload, end);
+    if (method == STORED_BLOCK){
+        if ((uint64_t)(end - payload) != length) throw runtime_error("Archive header is corrupted");
+        memcpy(out, payload, length);
+        return;
+    }
+    if (method == RUN_BLOCK){
+        int character = readByte(payload, end);
+        if (payload != end) throw runtime_error("Archive header is corrupted");
+        memset(out, character, length);
+        return;
+    }
+    if (method == SHARED_TABLE_BLOCK){
+        shared_ptr<const SharedTable> sharedTable = tables.get(readVarInt(payload, end));
+        decodeBlock(payload, end - payload, sharedTable->decodeTable, out, length);
+        return;
+    }
+    if (method == CONTEXT_BLOCK){
+        decodeContext(payload, end, out, length);
+        return;
+    }
+    if (method == ADAPTIVE_BLOCK){
+        int maxCodeLength = readByte(payload, end);
+        if (maxCodeLength < MIN_CODE_LENGTH_LIMIT || maxCodeLength > MAX_CODE_LENGTH){
+            throw runtime_error("Archive header is corrupted");
+        }
+        decodeAdaptive(payload, end - payload, maxCodeLength, out, length);
+        return;
+    }
+    if (method != HUFFMAN_BLOCK && method != INTERLEAVED_BLOCK) throw runtime_error("Unknown method of the block");
+
+    /* Reading code lengths and restoring the codes of the characters*/
+    HuffmanCode table[BYTES_NUMBER];
+    readCodeLengths(payload, end, table);
+
+    if (method == INTERLEAVED_BLOCK){
+        uint64_t streamSizes[STREAMS_NUMBER];
+        uint64_t bodySize = 0;
+        for (int i = 0; i < STREAMS_NUMBER - 1; i++){
+            streamSizes[i] = readVarInt(payload, end);
+            bodySize += streamSizes[i];
+            if (streamSizes[i] > (uint64_t)(end - payload) || bodySize > (uint64_t)(end - payload)){
+                throw runtime_error("Archive header is corrupted");
+            }
+        }
+        streamSizes[STREAMS_NUMBER - 1] = (end - payload) - bodySize;
+        decodeStreams(payload, streamSizes, table, out, length);
+        return;
+    }
+
+    decodeBlock(payload, end - payload, table, out, length);
+}
+
+/**
+ * Function: readChecksum
+ * Usage: uint32_t checksum = readChecksum(next, end);
+ * --------------------------------------------------------------------------------
+ *
+ * This function reads checksum of the block, lowest byte goes first.
+ *
+ * @param data Pointer to the checksum, moved to the next byte after it.
+ * @param end End of the data.
+ * @return Checksum read from the data
+ */
+uint32_t readChecksum(const char *&data, const char *end){
+    uint32_t checksum = 0;
+    for (int i = 0; i < CHECKSUM_SIZE; i++){
+        checksum |= (uint32_t)readByte(data, end) << (8 * i);
+    }
+    return checksum;
+}
+
+/**
+ * Function: checkBlock
+ * Usage: checkBlock(buffer, length, checksum);
+ * --------------------------------------------------------------------------------
+ *
+ * This function throws an exception if checksum of the decoded block differs from the
+ * stored one.
+ *
+ * @param data Decoded characters of the block.
+ * @param length Number of the characters.
+ * @param checksum Checksum stored in the archive.
+ */
+void checkBlock(const char *data, uint64_t length, uint32_t checksum){
+    if (crc32c(data, length) != checksum) throw runtime_error("Archive block is corrupted");
+}
+
+/**
+ * Function: getMemberName
+ * Usage: member.name = getMemberName(filename);
+ * --------------------------------------------------------------------------------
+ *
+ * This function makes name of the file in the container relative and normal: empty components
+ * and "." are removed, ".." removes the previous component, leading ".." are dropped. So files
+ * are restored inside the chosen directory and every packed name passes isSafeMemberName.
+ *
+ * @param filename Name of the packed file.
+ * @return Name of the file in the container, empty if the name has no components left.
+ */
+string getMemberName(const string &filename){
+    vector<string> components;
+    size_t start = 0;
+    while (start <= filename.length()){
+        size_t separator = filename.find('/', start);
+        if (separator == string::npos) separator = filename.length();
+        string component = filename.substr(start, separator - start);
+        if (component == ".."){
+            if (!components.empty()) components.pop_back();
+        } else if (!component.empty() && component != "."){
+            components.push_back(component);
+        }
+        start = separator + 1;
+    }
+
+    string name;
+    for (size_t i = 0; i < components.size(); i++){
+        if (i > 0) name += '/';
+        name += components[i];
+    }
+    return name;
+}
+
+/**
+ * Function: isSafeMemberName
+ * Usage: if (isSafeMemberName(member.name))...
+ * --------------------------------------------------------------------------------
+ *
+ * @param name Name of the file read from the container.
+ * @return true if the name is relative and has no empty components, "." or "..".
+ */
+bool isSafeMemberName(const string &name){
+    if (name.empty()) return false;
+    string path = "/" + name + "/";
+    return path.find("/../") == string::npos && path.find("/./") == string::npos && path.find("//") == string::npos;
+}
+
+/**
+ * Function: openMemberFile
+ * Usage: openMemberFile(out, directory + "/" + member.name);
+ * --------------------------------------------------------------------------------
+ *
+ * This function closes previous file of the stream and creates the next one with its
+ * directories.
+ *
+ * @param out Output file stream.
+ * @param filename Name of the new file.
+ */
+void openMemberFile(ofstream &out, const string &filename){
+    if (out.is_open()){
+        out.close();
+        if (!out) throw runtime_error("Could not write the decoded data");
+    }
+    createDirectories(filename);
+    out.open(filename, ofstream::binary);
+    if (!out) throw runtime_error("Could not write " + filename);
+}
+
+/**
+ * Function: readVarInt
+ * Usage: uint64_t value = readVarInt(next, end);
+ * -----------------------------------------------
+ * This function reads number written by writeVarInt.
+ *
+ * @param data Pointer to the number, moved to the next byte after it.
+ * @param end End of the data.
+ * @return Number read from the data
+ */
+uint64_t readVarInt(const char *&data, const char *end){
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7){
+        int byte = readByte(data, end);
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    return result;
+}
+
+/**
+ * Function: readVarInt
+ * Usage: uint64_t value = readVarInt(in, archiveSize);
+ * -----------------------------------------------
+ * This function reads number written by writeVarInt from the stream.
+ *
+ * @param in Input stream.
+ * @param bytesRead Number of bytes read from the stream, increased by the size of the number.
+ * @return Number read from the stream
+ */
+uint64_t readVarInt(istream &in, uint64_t &bytesRead){
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7){
+        int byte = in.get();
+        if (byte == istream::traits_type::eof()) throw runtime_error("Unexpected end of the archive");
+        bytesRead++;
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    return result;
+}
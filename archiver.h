@@ -0,0 +1,240 @@
+/* File: archiver.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports the archiver, which codes data by Huffman's algorithm
+ * to the archive format and decodes it back. Data could be coded from
+ * the memory buffer to the memory buffer, from the file to the file or
+ * from the stream to the stream.
+ */
+
+#ifndef ARCHIVER_H
+#define ARCHIVER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "blockcoder.h"
+#include "sharedtable.h"
+#include "threadpool.h"
+
+/* Structure to save options of the archivation*/
+struct ArchiveOptions {
+    int maxCodeLength = DEFAULT_MAX_CODE_LENGTH; // no code of the character is longer then this number of bits
+    int threadsNumber = 1; // number of threads for coding blocks
+    bool adaptive = false; // blocks are coded in one pass by the adaptive model
+    bool sampled = false; // frequencies of the characters are estimated by the part of the block
+    bool contextModel = false; // characters are coded by the tables chosen by the previous character
+    bool interleaved = false; // body of the block is divided into streams decoded together
+    uint64_t sharedTable = 0; // number of the shared table coding all blocks, 0 if every block has its own table
+    std::string tablesDirectory = "."; // directory with the files of the shared tables
+};
+
+/* Structure to save one block of the source data and its coded version*/
+struct ArchiveBlock {
+    const char *source = nullptr; // characters of the source data
+    size_t sourceLength = 0;
+    std::vector<char> sourceBuffer; // characters read from the stream or decoded ones
+    uint32_t checksum = 0; // CRC32C of the source characters
+    std::string header; // method of coding the block and lengths of the codes in binary format
+    std::vector<char> body; // coded characters or the whole payload read from the stream
+};
+
+/* Structure to save position of the block in the archive and in the source data*/
+struct BlockInfo {
+    uint64_t archiveOffset = 0;
+    uint64_t recordSize = 0; // size of the block in the archive
+    uint64_t sourceOffset = 0;
+    uint64_t sourceLength = 0;
+};
+
+/* Structure to save block index read from the end of the archive*/
+struct ArchiveIndex {
+    uint64_t blockSize = 0;
+    uint64_t sourceLength = 0;
+    std::vector<BlockInfo> blocks;
+};
+
+/* Structure to save one file of the container*/
+struct ArchiveMember {
+    std::string name; // relative name of the file with its directories
+    uint64_t sourceLength = 0;
+    uint64_t archiveOffset = 0; // position of the first block of the file in the container
+    uint64_t archiveSize = 0; // size of all blocks of the file in the container
+};
+
+/* Class: Archiver
+ * --------------------------------------------------------------
+ *
+ * This class is a context of the archivation. It keeps the pool of
+ * threads and buffers of the coded blocks between calls, so the same
+ * object could be used for coding a lot of data without new allocations.
+ * One object should be used by one thread at once.
+ */
+class Archiver{
+
+public:
+
+    /* Constructor: Archiver
+     * Usage: Archiver archiver(options);
+     * -----------------------------------------------------
+     * Initializes a new archiver with received options. Throws an
+     * exception if the limit of the code length or number of the
+     * threads is out of the allowed range.
+     */
+    explicit Archiver(const ArchiveOptions &options = ArchiveOptions());
+
+    /* Method: encode
+     * Usage: archiver.encode(data, length, archive);
+     * -----------------------------------------------------
+     * Codes received bytes to the archive stored in the output buffer.
+     */
+    void encode(const uint8_t *data, size_t length, std::vector<uint8_t> &out);
+
+    /* Method: decode
+     * Usage: archiver.decode(archive.data(), archive.size(), data);
+     * -----------------------------------------------------
+     * Decodes the archive stored in the memory to the output buffer.
+     * Throws an exception if archive is corrupted.
+     */
+    void decode(const uint8_t *data, size_t length, std::vector<uint8_t> &out);
+
+    /* Method: encodeStream
+     * Usage: archiver.encodeStream(cin, cout);
+     * -----------------------------------------------------
+     * Codes data from the input stream to the archive written to the output
+     * stream. Streams are read and written sequentially, so they could be pipes.
+     */
+    void encodeStream(std::istream &in, std::ostream &out);
+
+    /* Method: decodeStream
+     * Usage: archiver.decodeStream(cin, cout);
+     * -----------------------------------------------------
+     * Decodes archive read from the input stream to the output stream.
+     * Only a few blocks are kept in the memory at once.
+     */
+    void decodeStream(std::istream &in, std::ostream &out);
+
+    /* Method: archiveFile
+     * Usage: archiver.archiveFile(filename, filename + ".huf");
+     * -----------------------------------------------------
+     * Codes the source file to the archive file.
+     */
+    void archiveFile(const std::string &sourceName, const std::string &resultName);
+
+    /* Method: dearchiveFile
+     * Usage: archiver.dearchiveFile(archiveName, resultName);
+     * -----------------------------------------------------
+     * Decodes the archive file to the result file.
+     */
+    void dearchiveFile(const std::string &archiveName, const std::string &resultName);
+
+    /* Method: extractRange
+     * Usage: archiver.extractRange(archiveName, offset, length, cout);
+     * -----------------------------------------------------
+     * Writes received range of the source file from the archive file
+     * to the output stream, only blocks of the range are decoded.
+     */
+    void extractRange(const std::string &archiveName, uint64_t offset, uint64_t length, std::ostream &out);
+
+    /* Method: trainTable
+     * Usage: archiver.trainTable(corpusName, id);
+     * -----------------------------------------------------
+     * Builds shared table with received number from the sample file
+     * and saves it to the directory of the shared tables.
+     */
+    void trainTable(const std::string &corpusName, uint64_t id);
+
+    /* Method: packFiles
+     * Usage: archiver.packFiles(sourceNames, containerName);
+     * -----------------------------------------------------
+     * Codes received files and all files of the received directories
+     * to one container with the directory of the files at the end.
+     */
+    void packFiles(const std::vector<std::string> &sourceNames, const std::string &resultName);
+
+    /* Method: listMembers
+     * Usage: std::vector<ArchiveMember> members = archiver.listMembers(containerName);
+     * -----------------------------------------------------
+     * Returns files of the container read from its directory.
+     */
+    std::vector<ArchiveMember> listMembers(const std::string &containerName);
+
+    /* Method: extractMember
+     * Usage: archiver.extractMember(containerName, memberName, cout);
+     * -----------------------------------------------------
+     * Writes one file of the container to the output stream, only
+     * blocks of this file are decoded.
+     */
+    void extractMember(const std::string &containerName, const std::string &memberName, std::ostream &out);
+
+    /* Method: unpackFiles
+     * Usage: archiver.unpackFiles(containerName, directory);
+     * -----------------------------------------------------
+     * Restores all files of the container in the received directory.
+     */
+    void unpackFiles(const std::string &containerName, const std::string &directory);
+
+    /* Method: verifyFile
+     * Usage: uint64_t length = archiver.verifyFile(archiveName);
+     * -----------------------------------------------------
+     * Decodes all blocks of the archive or of the container to the
+     * memory and checks them by their checksums, nothing is written.
+     * Returns number of the checked characters, throws an exception
+     * if archive is corrupted.
+     */
+    uint64_t verifyFile(const std::string &archiveName);
+
+private:
+
+    ArchiveOptions options;
+    ThreadPool pool;
+    SharedTableCache tables; // shared tables used by the coded and decoded archives
+    std::vector<ArchiveBlock> blocks; // portion of the blocks coded in parallel
+    std::vector<BlockInfo> written; // sizes of the written blocks for the index
+    std::vector<char> rangeBuffer; // decoded block of the extracted range
+
+    /* Method: encodeArchive
+     * ------------------------------------------------
+     * Codes received data to the archive written to
+     * the output stream.
+     */
+    void encodeArchive(const char *data, uint64_t length, std::ostream &out);
+
+    /* Method: encodeBlocks
+     * ------------------------------------------------
+     * Codes first "count" blocks in parallel and writes
+     * them to the output stream.
+     */
+    uint64_t encodeBlocks(int count, std::ostream &out);
+
+    /* Method: finishArchive
+     * ------------------------------------------------
+     * Writes end of the blocks and index of the written
+     * blocks to the output stream.
+     */
+    void finishArchive(uint64_t archiveSize, std::ostream &out);
+
+    /* Method: decodeArchive
+     * ------------------------------------------------
+     * Decodes all blocks of the archive in parallel to
+     * the output buffer of the source data size.
+     */
+    void decodeArchive(const char *archive, const ArchiveIndex &index, char *out);
+
+    /* Method: decodeBlocks
+     * ------------------------------------------------
+     * Decodes received blocks of the archive in parallel
+     * to the buffers of the portion of the blocks.
+     */
+    void decodeBlocks(const char *archive, const BlockInfo *infos, int count);
+
+    /* Archiver could not be copied*/
+    Archiver(const Archiver &src);
+    Archiver & operator=(const Archiver &src);
+};
+
+#endif // ARCHIVER_H
@@ -0,0 +1,487 @@
+/* File: benchmark.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This is a benchmark of the archiver. It generates the same corpora at every run: text, binary,
+ * skewed, random and all-same-byte inputs of 1 KB, 1 MB and 1 GB, and optionally loads files
+ * received in the command line. Every corpus is coded block by block as the archiver does it,
+ * time of every stage (histogram, tree build, encode, decode) is measured separately and results
+ * are printed in JSON format: throughput in MB/s, compression ratio and peak memory usage of the
+ * process up to the end of every corpus.
+ * Model built from the sample of every block is compared with the exact one by the loss of the ratio.
+ * Order-1 coding by the tables of the previous characters is measured separately from the other stages.
+ * Code lengths built in place are checked against the tree built by the priority queue.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "blockcoder.h"
+#include "pqueueshpp.h"
+
+#include <sys/resource.h>
+
+using namespace std;
+
+/* Structure to save time spent on every stage of the coding*/
+struct StageTimes {
+    double histogram = 0;
+    double tree = 0;
+    double encode = 0;
+    double decode = 0;
+    double sampledHistogram = 0; // estimation of the frequencies by the sample
+    double contextEncode = 0; // counting, building tables and coding of the order-1 mode
+    double contextDecode = 0;
+    double streamsDecode = 0; // decoding of the block divided into interleaved streams
+};
+
+/* Structure to save result of the benchmark of one corpus*/
+struct BenchmarkResult {
+    string corpus;
+    uint64_t size = 0;
+    int passes = 0;
+    uint64_t compressedSize = 0; // code lengths and bodies of all blocks
+    uint64_t sampledSize = 0; // the same size with codes built from the sample of every block
+    uint64_t contextSize = 0; // the same size in order-1 mode, blocks not smaller with contexts are counted as usual
+    StageTimes times; // total time of all passes in seconds
+    long processPeakRss = 0; // peak resident memory of the process since its start in kilobytes
+};
+
+/* Function prototypes*/
+vector<char> generateCorpus(const string &kind, uint64_t size);
+vector<char> loadCorpus(const string &filename);
+uint64_t nextRandom(uint64_t &state);
+BenchmarkResult runBenchmark(const string &corpus, const vector<char> &data);
+double codePass(const vector<char> &data, StageTimes &times, BenchmarkResult &result);
+uint64_t getHeapCodedBits(const uint64_t *alphabet);
+double secondsSince(chrono::steady_clock::time_point start);
+void printResult(ostream &out, const BenchmarkResult &result);
+void printStage(ostream &out, const string &name, double seconds, uint64_t bytes);
+string jsonString(const string &text);
+
+const uint64_t RANDOM_SEED = 0x2545F4914F6CDD1DULL; // seed of the generator, same at every run
+const double MIN_BENCHMARK_TIME = 0.5; // small corpora are coded several times at least this number of seconds
+const int MAX_PASSES = 100000; // limit of the passes over the small corpus
+const char * const CORPUS_KINDS[] = {"text", "binary", "skewed", "random", "same"};
+const uint64_t CORPUS_SIZES[] = {1ULL << 10, 1ULL << 20, 1ULL << 30};
+
+/* Main program */
+int main(int argc, char* argv[]) {
+
+    uint64_t maxSize = CORPUS_SIZES[2];
+    vector<string> files;
+    for (int i = 1; i < argc; i++){
+        if (string(argv[i]) == "-quick"){
+            maxSize = CORPUS_SIZES[1];
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    try{
+        cout << "{" << endl;
+        cout << "  \"blockSize\": " << BLOCK_SIZE << "," << endl;
+        cout << "  \"maxCodeLength\": " << DEFAULT_MAX_CODE_LENGTH << "," << endl;
+        cout << "  \"results\": [";
+        bool first = true;
+        for (uint64_t size : CORPUS_SIZES){
+            if (size > maxSize) break;
+            for (const char *kind : CORPUS_KINDS){
+                vector<char> data = generateCorpus(kind, size);
+                cout << (first ? "" : ",") << endl;
+                printResult(cout, runBenchmark(kind, data));
+                first = false;
+            }
+        }
+        for (size_t i = 0; i < files.size(); i++){
+            vector<char> data = loadCorpus(files[i]);
+            cout << (first ? "" : ",") << endl;
+            printResult(cout, runBenchmark(files[i], data));
+            first = false;
+        }
+        cout << endl << "  ]" << endl << "}" << endl;
+    }
+    catch(exception &error){
+        cerr << "Benchmark failed: " << error.what() << endl;
+        return 1;
+    }
+    return 0;
+}
+
+/** Function: generateCorpus
+ * Usage: vector<char> data = generateCorpus("text", size);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function generates corpus of the received kind by the pseudorandom generator with
+ * fixed seed, so the same data is used at every run. Text consists of the words from small
+ * dictionary, short words are used more often. Binary imitates array of the records with
+ * counters, small numbers and zero padding. In skewed corpus every next character is twice
+ * less frequent then previous one. Random corpus has all characters with the same frequency
+ * and the last one consists of one repeated character.
+ *
+ * @param kind Kind of the corpus
+ * @param size Size of the corpus in bytes
+ * @return Generated corpus
+ */
+vector<char> generateCorpus(const string &kind, uint64_t size){
+    static const char * const WORDS[] = {
+        "the", "of", "and", "to", "in", "a", "is", "that", "for", "it", "as", "was", "with", "be",
+        "by", "on", "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have",
+        "an", "had", "they", "you", "were", "their", "one", "all", "we", "can", "her", "has",
+        "there", "been", "if", "more", "when", "will", "would", "who", "so", "no", "Huffman",
+        "archive", "frequency", "character", "table", "code", "block", "tree", "length"
+    };
+    const int WORDS_NUMBER = sizeof(WORDS) / sizeof(WORDS[0]);
+
+    vector<char> data;
+    data.reserve(size + 64); // generators could go a few bytes after the size
+    uint64_t state = RANDOM_SEED;
+    if (kind == "text"){
+        int wordsInLine = 0;
+        while (data.size() < size){
+            uint64_t random = nextRandom(state);
+            int word = (int)((random % WORDS_NUMBER) * ((random >> 32) % WORDS_NUMBER) / WORDS_NUMBER);
+            data.insert(data.end(), WORDS[word], WORDS[word] + strlen(WORDS[word]));
+            wordsInLine++;
+            if (wordsInLine == 12){
+                data.push_back('.');
+                data.push_back('\n');
+                wordsInLine = 0;
+            } else {
+                data.push_back(((random >> 16) % 16 == 0) ? ',' : ' ');
+            }
+        }
+    } else if (kind == "binary"){
+        for (uint32_t record = 0; data.size() < size; record++){
+            uint64_t random = nextRandom(state);
+            uint32_t fields[4] = {record, (uint32_t)(random % 1000), (uint32_t)(random >> 40), 0};
+            for (int i = 0; i < 16; i++){
+                data.push_back((char)(fields[i / 4] >> (8 * (i % 4))));
+            }
+        }
+    } else if (kind == "skewed"){
+        while (data.size() < size){
+            uint64_t random = nextRandom(state);
+            data.push_back((char)(random == 0 ? 63 : __builtin_ctzll(random)));
+        }
+    } else if (kind == "random"){
+        while (data.size() < size){
+            uint64_t random = nextRandom(state);
+            for (int i = 0; i < 8; i++){
+                data.push_back((char)(random >> (8 * i)));
+            }
+        }
+    } else if (kind == "same"){
+        data.assign(size, 'a');
+    } else {
+        throw runtime_error("Unknown corpus " + kind);
+    }
+    data.resize(size);
+    return data;
+}
+
+/** Function: loadCorpus
+ * Usage: vector<char> data = loadCorpus(filename);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function reads the whole file to the memory.
+ *
+ * @param filename Name of the file
+ * @return Content of the file
+ */
+vector<char> loadCorpus(const string &filename){
+    ifstream file(filename, ifstream::binary);
+    if (!file) throw runtime_error("Could not open " + filename);
+    return vector<char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+/** Function: nextRandom
+ * Usage: uint64_t random = nextRandom(state);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function returns next number of the xorshift64* pseudorandom generator.
+ *
+ * @param state State of the generator, should not be zero
+ * @return Next pseudorandom number
+ */
+uint64_t nextRandom(uint64_t &state){
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545F4914F6CDD1DULL;
+}
+
+/** Function: runBenchmark
+ * Usage: BenchmarkResult result = runBenchmark("text", data);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function codes and decodes the corpus several times, until MIN_BENCHMARK_TIME seconds
+ * are spent, and sums time of every stage of all passes. Peak memory is the high-water mark of
+ * the whole process, so it is never less then the peak of the corpora measured before.
+ *
+ * @param corpus Name of the corpus
+ * @param data Content of the corpus
+ * @return Result of the benchmark
+ */
+BenchmarkResult runBenchmark(const string &corpus, const vector<char> &data){
+    BenchmarkResult result;
+    result.corpus = corpus;
+    result.size = data.size();
+
+    double totalTime = 0;
+    while (result.passes == 0 || (totalTime < MIN_BENCHMARK_TIME && result.passes < MAX_PASSES)){
+        totalTime += codePass(data, result.times, result);
+        result.passes++;
+    }
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result.processPeakRss = usage.ru_maxrss;
+    return result;
+}
+
+/** Function: codePass
+ * Usage: double seconds = codePass(data, result.times, result);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function divides the corpus into blocks of BLOCK_SIZE characters and passes every block
+ * through all stages of the archiver, time of every stage is added to the received times.
+ * Decoded block is compared with the source one. Also frequencies of every block are estimated
+ * by the sample and size of the block coded by the codes of the sample is calculated from the
+ * exact frequencies, time of the sampling is not included to the time of the pass. At the end
+ * block is coded and decoded in order-1 mode and decoded from the interleaved streams, this time is
+ * not included too. Codes without the limit of the length should code the block by the same number
+ * of bits as the tree built by the priority queue.
+ *
+ * @param data Content of the corpus
+ * @param times Time of the stages
+ * @param result Result, which sizes of the coded blocks are set
+ * @return Time of the pass in seconds
+ */
+double codePass(const vector<char> &data, StageTimes &times, BenchmarkResult &result){
+    static vector<char> body;
+    static vector<char> contextBody;
+    static vector<char> streamsBody;
+    static vector<char> decoded(BLOCK_SIZE);
+
+    uint64_t &compressedSize = result.compressedSize;
+    uint64_t &sampledSize = result.sampledSize;
+    compressedSize = 0;
+    sampledSize = 0;
+    result.contextSize = 0;
+    double passTime = 0;
+    for (size_t position = 0; position < data.size(); position += BLOCK_SIZE){
+        const char *source = data.data() + position;
+        size_t length = min((size_t)BLOCK_SIZE, data.size() - position);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        uint64_t alphabet[BYTES_NUMBER];
+        getAlphabet(source, length, alphabet);
+        double histogramTime = secondsSince(start);
+
+        start = chrono::steady_clock::now();
+        HuffmanCode table[BYTES_NUMBER];
+        buildCodes(alphabet, DEFAULT_MAX_CODE_LENGTH, table);
+        double treeTime = secondsSince(start);
+
+        start = chrono::steady_clock::now();
+        string codeLengths = getCodeLengthsForFile(table);
+        body.clear();
+        encodeBody(source, length, table, body);
+        double encodeTime = secondsSince(start);
+
+        start = chrono::steady_clock::now();
+        HuffmanCode restored[BYTES_NUMBER];
+        const char *next = codeLengths.data();
+        readCodeLengths(next, next + codeLengths.size(), restored);
+        decodeBlock(body.data(), body.size(), restored, decoded.data(), length);
+        double decodeTime = secondsSince(start);
+
+        if (memcmp(source, decoded.data(), length) != 0) throw runtime_error("Decoded block differs from the source");
+
+        start = chrono::steady_clock::now();
+        uint64_t sample[BYTES_NUMBER];
+        getSampledAlphabet(source, length, sample);
+        times.sampledHistogram += secondsSince(start);
+
+        HuffmanCode sampledTable[BYTES_NUMBER];
+        buildCodes(sample, DEFAULT_MAX_CODE_LENGTH, sampledTable);
+        uint64_t sampledBits = 0;
+        for (int i = 0; i < BYTES_NUMBER; i++){
+            sampledBits += alphabet[i] * sampledTable[i].length;
+        }
+        sampledSize += getCodeLengthsForFile(sampledTable).size() + (sampledBits + 7) / 8;
+
+        HuffmanCode optimalTable[BYTES_NUMBER];
+        buildCodes(alphabet, MAX_CODE_LENGTH, optimalTable);
+        uint64_t optimalBits = 0;
+        for (int i = 0; i < BYTES_NUMBER; i++){
+            optimalBits += alphabet[i] * optimalTable[i].length;
+        }
+        if (optimalBits != getHeapCodedBits(alphabet)) throw runtime_error("Code lengths are not optimal");
+
+        start = chrono::steady_clock::now();
+        string contextHeader;
+        contextBody.clear();
+        bool contextUsed = encodeContext(source, length, DEFAULT_MAX_CODE_LENGTH, contextHeader, contextBody);
+        times.contextEncode += secondsSince(start);
+        if (contextUsed){
+            start = chrono::steady_clock::now();
+            contextHeader += string(contextBody.begin(), contextBody.end());
+            decodeContext(contextHeader.data(), contextHeader.data() + contextHeader.size(), decoded.data(), length);
+            times.contextDecode += secondsSince(start);
+            if (memcmp(source, decoded.data(), length) != 0) throw runtime_error("Decoded block differs from the source");
+            result.contextSize += contextHeader.size();
+        } else {
+            result.contextSize += codeLengths.size() + body.size();
+        }
+
+        uint64_t streamSizes[STREAMS_NUMBER];
+        streamsBody.clear();
+        encodeStreams(source, length, table, streamSizes, streamsBody);
+        start = chrono::steady_clock::now();
+        decodeStreams(streamsBody.data(), streamSizes, restored, decoded.data(), length);
+        times.streamsDecode += secondsSince(start);
+        if (memcmp(source, decoded.data(), length) != 0) throw runtime_error("Decoded block differs from the source");
+
+        times.histogram += histogramTime;
+        times.tree += treeTime;
+        times.encode += encodeTime;
+        times.decode += decodeTime;
+        passTime += histogramTime + treeTime + encodeTime + decodeTime;
+        compressedSize += codeLengths.size() + body.size();
+    }
+    return passTime;
+}
+
+/** Function: getHeapCodedBits
+ * Usage: uint64_t bits = getHeapCodedBits(alphabet);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function builds the Huffman tree by the priority queue, two smallest weights are
+ * combined until one is left. Every combined weight adds one bit to the codes of all characters
+ * under it, so sum of the combined weights is the number of bits of the block coded by the
+ * optimal codes. Single used character is coded by one bit as in the archiver.
+ *
+ * @param alphabet Array of BYTES_NUMBER frequencies of the characters
+ * @return Number of bits of the block coded by the optimal codes
+ */
+uint64_t getHeapCodedBits(const uint64_t *alphabet){
+    PQueueSHPP<uint64_t> queue;
+    queue.reserve(BYTES_NUMBER);
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (alphabet[i] != 0) queue.enqueue(alphabet[i], alphabet[i]);
+    }
+    if (queue.size() == 1) return queue.peekPriority();
+
+    uint64_t bits = 0;
+    while (queue.size() > 1){
+        uint64_t weight = queue.dequeue() + queue.dequeue();
+        bits += weight;
+        queue.enqueue(weight, weight);
+    }
+    return bits;
+}
+
+/** Function: secondsSince
+ * Usage: double seconds = secondsSince(start);
+ * ------------------------------------------------------------------------------------
+ *
+ * @param start Time of the beginning
+ * @return Number of seconds passed from the received time
+ */
+double secondsSince(chrono::steady_clock::time_point start){
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/** Function: printResult
+ * Usage: printResult(cout, result);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function prints result of the benchmark as JSON object. Throughput of every stage
+ * is calculated in MB/s of the source data, one megabyte is 1000000 bytes.
+ *
+ * @param out Output stream
+ * @param result Result of the benchmark
+ */
+void printResult(ostream &out, const BenchmarkResult &result){
+    uint64_t bytes = result.size * result.passes;
+    double ratio = (result.size > 0) ? (double)result.compressedSize / result.size : 0;
+    double sampledRatio = (result.size > 0) ? (double)result.sampledSize / result.size : 0;
+    double ratioLoss = (result.compressedSize > 0) ? (double)result.sampledSize / result.compressedSize - 1 : 0;
+    double contextRatio = (result.size > 0) ? (double)result.contextSize / result.size : 0;
+    out << "    {\"corpus\": " << jsonString(result.corpus) << ", \"size\": " << result.size
+        << ", \"passes\": " << result.passes << ", \"compressedSize\": " << result.compressedSize
+        << ", \"ratio\": " << ratio << "," << endl;
+    out << "     \"sampledSize\": " << result.sampledSize << ", \"sampledRatio\": " << sampledRatio
+        << ", \"ratioLoss\": " << ratioLoss << "," << endl;
+    out << "     \"contextSize\": " << result.contextSize << ", \"contextRatio\": " << contextRatio << "," << endl;
+    out << "     \"stages\": {";
+    printStage(out, "histogram", result.times.histogram, bytes);
+    out << ", ";
+    printStage(out, "tree", result.times.tree, bytes);
+    out << ", ";
+    printStage(out, "encode", result.times.encode, bytes);
+    out << ", ";
+    printStage(out, "decode", result.times.decode, bytes);
+    out << ", ";
+    printStage(out, "sampledHistogram", result.times.sampledHistogram, bytes);
+    out << ", ";
+    printStage(out, "contextEncode", result.times.contextEncode, bytes);
+    out << ", ";
+    printStage(out, "contextDecode", result.times.contextDecode, bytes);
+    out << ", ";
+    printStage(out, "streamsDecode", result.times.streamsDecode, bytes);
+    out << "}," << endl;
+    out << "     \"processPeakRssKb\": " << result.processPeakRss << "}";
+}
+
+/** Function: printStage
+ * Usage: printStage(out, "encode", seconds, bytes);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function prints time and throughput of one stage as JSON member.
+ *
+ * @param out Output stream
+ * @param name Name of the stage
+ * @param seconds Total time of the stage
+ * @param bytes Number of the source bytes processed by the stage
+ */
+void printStage(ostream &out, const string &name, double seconds, uint64_t bytes){
+    double speed = (seconds > 0) ? bytes / seconds / 1e6 : 0;
+    out << "\"" << name << "\": {\"seconds\": " << seconds << ", \"mbps\": " << speed << "}";
+}
+
+/** Function: jsonString
+ * Usage: out << jsonString(filename);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function quotes the text as JSON string, escaping quotes, backslashes and control characters.
+ *
+ * @param text Text to quote
+ * @return JSON string
+ */
+string jsonString(const string &text){
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    string result = "\"";
+    for (size_t i = 0; i < text.size(); i++){
+        unsigned char ch = text[i];
+        if (ch == '"' || ch == '\\'){
+            result += '\\';
+            result += ch;
+        } else if (ch < 0x20){
+            result += "\\u00";
+            result += HEX_DIGITS[ch >> 4];
+            result += HEX_DIGITS[ch & 0xF];
+        } else {
+            result += ch;
+        }
+    }
+    return result + "\"";
+}
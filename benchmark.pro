@@ -0,0 +1,23 @@
+#-------------------------------------------------
+#
+# Benchmark of the archiver stages, prints results in JSON format
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = benchmark
+CONFIG   += console
+CONFIG   -= app_bundle
+CONFIG += c++11
+CONFIG += thread
+
+DEFINES += _FILE_OFFSET_BITS=64
+
+TEMPLATE = app
+
+
+SOURCES += \
+    benchmark.cpp
+
+include(huffmanlib.pri)
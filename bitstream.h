@@ -0,0 +1,234 @@
+/* File: bitstream.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports simple bit-level writer and reader used by the archiver.
+ * Bits are packed most significant bit first, so the first bit of
+ * the stream is the highest bit of the first byte.
+ */
+
+#ifndef BITSTREAM_H
+#define BITSTREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Class: BitWriter
+ * --------------------------------------------------------------
+ *
+ * This class packs variable length codes into a 64-bit accumulator
+ * and moves complete bytes to the small output buffer. When the buffer
+ * is full it is appended to the received byte array.
+ */
+class BitWriter{
+
+public:
+
+    /* Constructor: BitWriter
+     * Usage: BitWriter writer(body);
+     * -----------------------------------------------------
+     * Initializes a new writer, which appends bytes to the
+     * end of the received array.
+     */
+    explicit BitWriter(std::vector<char> &out);
+
+    /* Method: writeBits
+     * Usage: writer.writeBits(code, length);
+     * -----------------------------------------------------
+     * Appends lowest "length" bits of the "bits" to the stream.
+     * Length could be from 0 to 64 bits.
+     */
+    void writeBits(uint64_t bits, int length);
+
+    /* Method: flush
+     * Usage: writer.flush();
+     * -----------------------------------------------------
+     * Pads last incomplete byte with zero bits and appends all
+     * buffered bytes to the output array.
+     */
+    void flush();
+
+    /* Method: bytesWritten
+     * Usage: uint64_t size = writer.bytesWritten();
+     * -----------------------------------------------------
+     * Returns number of the bytes passed to the output array.
+     */
+    uint64_t bytesWritten() const;
+
+private:
+
+    /* Size of the output buffer in bytes*/
+    static const int BUFFER_SIZE = 1 << 16;
+
+    std::vector<char> &out;
+    std::vector<char> buffer;
+    int bufferPos;
+    uint64_t flushedBytes;
+
+    /* Not yet written bits are stored in lowest "bitCount" bits*/
+    uint64_t accumulator;
+    int bitCount;
+
+    /* Method: putWord
+     * Usage: putWord(word);
+     * ------------------------------------------------
+     * Moves 32 bits of the accumulator to the output buffer
+     */
+    void putWord(uint32_t word);
+
+    /* Method: flushBuffer
+     * Usage: flushBuffer();
+     * ------------------------------------------------
+     * Appends content of the output buffer to the array
+     */
+    void flushBuffer();
+};
+
+
+inline BitWriter::BitWriter(std::vector<char> &out) : out(out), buffer(BUFFER_SIZE){
+    bufferPos = 0;
+    flushedBytes = 0;
+    accumulator = 0;
+    bitCount = 0;
+}
+
+inline void BitWriter::writeBits(uint64_t bits, int length){
+    if (length > 32){
+        writeBits(bits >> 32, length - 32);
+        bits &= 0xFFFFFFFFu;
+        length = 32;
+    }
+
+    /* At this point bitCount is less then 32, so the new bits always fit in accumulator*/
+    accumulator = (accumulator << length) | bits;
+    bitCount += length;
+    if (bitCount >= 32){
+        bitCount -= 32;
+        putWord((uint32_t)(accumulator >> bitCount));
+    }
+}
+
+inline void BitWriter::putWord(uint32_t word){
+    if (bufferPos + 4 > BUFFER_SIZE) flushBuffer();
+    buffer[bufferPos++] = (char)(word >> 24);
+    buffer[bufferPos++] = (char)(word >> 16);
+    buffer[bufferPos++] = (char)(word >> 8);
+    buffer[bufferPos++] = (char)word;
+}
+
+inline void BitWriter::flushBuffer(){
+    out.insert(out.end(), buffer.begin(), buffer.begin() + bufferPos);
+    flushedBytes += bufferPos;
+    bufferPos = 0;
+}
+
+inline void BitWriter::flush(){
+    while (bitCount > 0){
+        if (bufferPos == BUFFER_SIZE) flushBuffer();
+        int shift = bitCount - 8;
+        unsigned char byte = (shift >= 0) ? (unsigned char)(accumulator >> shift)
+                                          : (unsigned char)(accumulator << -shift);
+        buffer[bufferPos++] = (char)byte;
+        bitCount -= 8;
+    }
+    bitCount = 0;
+    accumulator = 0;
+    flushBuffer();
+}
+
+inline uint64_t BitWriter::bytesWritten() const{
+    return flushedBytes + bufferPos;
+}
+
+/* Class: BitReader
+ * --------------------------------------------------------------
+ *
+ * This class reads bits from the byte array through the 64-bit
+ * accumulator. After refill() at least 56 bits could be peeked at once,
+ * what is enough for several table lookups. When array is over
+ * the accumulator is padded with zero bits.
+ */
+class BitReader{
+
+public:
+
+    /* Constructor: BitReader
+     * Usage: BitReader reader(body.data(), body.size());
+     * -----------------------------------------------------
+     * Initializes a new reader of the received array.
+     */
+    BitReader(const char *data, size_t size);
+
+    /* Method: refill
+     * Usage: reader.refill();
+     * -----------------------------------------------------
+     * Loads next bytes of the stream to the accumulator, so at least
+     * 56 bits are available for peekBits.
+     */
+    void refill();
+
+    /* Method: peekBits
+     * Usage: uint32_t index = reader.peekBits(bits);
+     * -----------------------------------------------------
+     * Returns next "length" bits of the stream without removing them.
+     * Length could be from 1 to 32 bits.
+     */
+    uint32_t peekBits(int length) const;
+
+    /* Method: skipBits
+     * Usage: reader.skipBits(length);
+     * -----------------------------------------------------
+     * Removes "length" already peeked bits from the accumulator.
+     */
+    void skipBits(int length);
+
+private:
+
+    const unsigned char *next;
+    const unsigned char *end;
+
+    /* Bits are stored in highest "bitCount" bits of the accumulator*/
+    uint64_t accumulator;
+    int bitCount;
+};
+
+
+inline BitReader::BitReader(const char *data, size_t size){
+    next = (const unsigned char*)data;
+    end = next + size;
+    accumulator = 0;
+    bitCount = 0;
+}
+
+inline void BitReader::refill(){
+    if (end - next >= 8){
+        /* Fast path: load 8 bytes at once and count only the whole bytes, what fit in accumulator.
+         * Lowest bits of the word are loaded again by the next refill with the same values.
+         */
+        const unsigned char *p = next;
+        uint64_t word = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) |
+                        ((uint64_t)p[3] << 32) | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+                        ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+        accumulator |= word >> bitCount;
+        int bytes = (63 - bitCount) >> 3;
+        next += bytes;
+        bitCount += bytes * 8;
+    } else {
+        while (bitCount <= 56){
+            uint64_t byte = (next < end) ? *next++ : 0;
+            accumulator |= byte << (56 - bitCount);
+            bitCount += 8;
+        }
+    }
+}
+
+inline uint32_t BitReader::peekBits(int length) const{
+    return (uint32_t)(accumulator >> (64 - length));
+}
+
+inline void BitReader::skipBits(int length){
+    accumulator <<= length;
+    bitCount -= length;
+}
+
+#endif // BITSTREAM_H
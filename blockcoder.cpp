@@ -0,0 +1,699 @@
+/* File: blockcoder.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements coding of one block by Huffman's algorithm: counting of the characters,
+ * building of the Huffman tree and canonical codes, packing and unpacking of the codes.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "bitstream.h"
+#include "blockcoder.h"
+#include "histogram.h"
+
+using namespace std;
+
+/* Function prototypes*/
+void getCodeLengths(const uint64_t *alphabet, HuffmanCode *table);
+void calculateLengths(uint64_t *weights, int count);
+uint64_t getCodedBits(const uint64_t *alphabet, const HuffmanCode *table);
+
+const int CODE_LIST_LIMIT = 32; // from this number of used characters code lengths are stored with bitmap
+const size_t SAMPLE_SIZE = 1 << 12; // number of the characters counted from every part of the sampled block
+const size_t SAMPLE_STRIDE = 1 << 15; // distance between the counted parts of the sampled block
+const size_t ADAPTIVE_FIRST_PERIOD = 1 << 6; // adaptive model is rebuilt first time after this number of characters
+const size_t ADAPTIVE_MAX_PERIOD = 1 << 16; // period of rebuilding is doubled up to this number of characters
+
+/** Function: getAlphabet
+ * Usage: getAlphabet(block.source, block.sourceLength, alphabet);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function read all characters in the recieved array and put their
+ * frequencies to the alphabet. Characters are counted by countBytes, which uses
+ * several tables and vector instructions of the processor.
+ *
+ * @param data Array of the characters
+ * @param length Number of the characters
+ * @param alphabet Array of BYTES_NUMBER elements for the frequencies of the characters
+ */
+void getAlphabet(const char *data, size_t length, uint64_t *alphabet){
+    for(int i = 0; i < BYTES_NUMBER; i++){
+        alphabet[i] = 0;
+    }
+    countBytes(data, length, alphabet);
+}
+
+/** Function: getSampledAlphabet
+ * Usage: getSampledAlphabet(block.source, block.sourceLength, alphabet);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function estimates frequencies of the characters without reading the whole array. Only first
+ * SAMPLE_SIZE characters of every SAMPLE_STRIDE characters are counted and their frequencies are scaled
+ * to the whole array. One is added to every frequency, so the characters which are not in the sample
+ * still get codes, the longest ones. Short arrays are counted completely as by getAlphabet.
+ *
+ * @param data Array of the characters
+ * @param length Number of the characters
+ * @param alphabet Array of BYTES_NUMBER elements for the frequencies of the characters
+ */
+void getSampledAlphabet(const char *data, size_t length, uint64_t *alphabet){
+    if (length < 2 * SAMPLE_STRIDE){
+        getAlphabet(data, length, alphabet);
+        return;
+    }
+
+    uint64_t sample[BYTES_NUMBER] = {0};
+    for (size_t pos = 0; pos < length; pos += SAMPLE_STRIDE){
+        countBytes(data + pos, min(SAMPLE_SIZE, length - pos), sample);
+    }
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        alphabet[i] = sample[i] * (SAMPLE_STRIDE / SAMPLE_SIZE) + 1;
+    }
+}
+
+/** Function: estimateCodedSize
+ * Usage: if (estimateCodedSize(alphabet, block.sourceLength) >= block.sourceLength)...
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function calculates entropy of the characters by their frequencies, the lowest average
+ * number of bits for one character, which no prefix code could beat. Size of the code lengths
+ * is found for the same used characters as in getCodeLengthsForFile. So the block could be
+ * left uncoded without building the codes, if this estimation is not smaller then the block.
+ *
+ * @param alphabet Frequencies of the characters, counted exactly or by the sample
+ * @param length Number of the characters in the block
+ * @return Estimated size of the coded block in bytes
+ */
+uint64_t estimateCodedSize(const uint64_t *alphabet, size_t length){
+    uint64_t total = 0;
+    int used = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        total += alphabet[i];
+        used += (alphabet[i] != 0);
+    }
+    if (total == 0) return 0;
+
+    double entropy = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (alphabet[i] != 0) entropy -= alphabet[i] * log2((double)alphabet[i] / total);
+    }
+    uint64_t bodySize = (uint64_t)(entropy / total * length / 8);
+    return 1 + ((used < CODE_LIST_LIMIT) ? 2 * used : BYTES_NUMBER / 8 + used) + bodySize;
+}
+
+/** Function: buildCodes
+ * Usage: buildCodes(alphabet, options.maxCodeLength, table);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function finds lengths of the Huffman codes for all used characters, shortens codes longer
+ * then allowed and replace the codes with canonical codes of the same lengths.
+ *
+ * @param alphabet Array of BYTES_NUMBER frequencies of the characters
+ * @param maxCodeLength Limit of the code length
+ * @param table Array for the codes of the characters
+ */
+void buildCodes(const uint64_t *alphabet, int maxCodeLength, HuffmanCode *table){
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        table[i] = HuffmanCode();
+    }
+
+    getCodeLengths(alphabet, table);
+    limitCodeLengths(table, alphabet, maxCodeLength);
+    assignCanonicalCodes(table);
+}
+
+/** Function: getCodeLengths
+ * Usage: getCodeLengths(alphabet, table);
+ * ---------------------------------------------------------------------------------
+ *
+ * This function sorts used characters by their frequencies once, ties are ordered by
+ * characters, and calculates lengths of the Huffman codes in the array of the sorted
+ * frequencies. No tree is allocated. Single used character still gets one bit code.
+ *
+ * @param alphabet Array of BYTES_NUMBER frequencies of the characters
+ * @param table Array of the codes, lengths of the used characters are set
+ */
+void getCodeLengths(const uint64_t *alphabet, HuffmanCode *table){
+    int characters[BYTES_NUMBER];
+    int count = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (alphabet[i] != 0) characters[count++] = i;
+    }
+    if (count == 0) return;
+    if (count == 1){
+        table[characters[0]].length = 1;
+        return;
+    }
+
+    sort(characters, characters + count, [alphabet](int a, int b){
+        return alphabet[a] < alphabet[b] || (alphabet[a] == alphabet[b] && a < b);
+    });
+    uint64_t weights[BYTES_NUMBER];
+    for (int i = 0; i < count; i++){
+        weights[i] = alphabet[characters[i]];
+    }
+    calculateLengths(weights, count);
+    for (int i = 0; i < count; i++){
+        table[characters[i]].length = (int)weights[i];
+    }
+}
+
+/** Function: calculateLengths
+ * Usage: calculateLengths(weights, count);
+ * ---------------------------------------------------------------------------------
+ *
+ * This function replaces sorted frequencies with lengths of the Huffman codes by the
+ * in-place method of Moffat and Katajainen. Huffman's algorithm combines two smallest
+ * weights, and sums are made in increasing order, so they form the second sorted queue
+ * after the leaves. First pass merges leaves and sums from left to right, every merged
+ * sum stores index of its parent. Second pass turns parent indexes into depths of the
+ * internal nodes, third pass counts nodes at every depth and gives the rest places at
+ * this depth to the leaves from right to left.
+ *
+ * @param weights Frequencies sorted from the smallest, replaced by the code lengths
+ * @param count Number of the frequencies, at least two
+ */
+void calculateLengths(uint64_t *weights, int count){
+    /* First pass: weights of the internal nodes and their parents */
+    weights[0] += weights[1];
+    int root = 0, leaf = 2;
+    for (int next = 1; next < count - 1; next++){
+        if (leaf >= count || weights[root] < weights[leaf]){
+            weights[next] = weights[root];
+            weights[root++] = next;
+        } else {
+            weights[next] = weights[leaf++];
+        }
+        if (leaf >= count || (root < next && weights[root] < weights[leaf])){
+            weights[next] += weights[root];
+            weights[root++] = next;
+        } else {
+            weights[next] += weights[leaf++];
+        }
+    }
+
+    /* Second pass: depths of the internal nodes */
+    weights[count - 2] = 0;
+    for (int next = count - 3; next >= 0; next--){
+        weights[next] = weights[weights[next]] + 1;
+    }
+
+    /* Third pass: depths of the leaves */
+    int available = 1, used = 0, depth = 0;
+    root = count - 2;
+    int next = count - 1;
+    while (available > 0){
+        while (root >= 0 && (int)weights[root] == depth){
+            used++;
+            root--;
+        }
+        while (available > used){
+            weights[next--] = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+/** Function: encodeBody
+ * Usage: encodeBody(block.source, block.sourceLength, table, block.body);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function packs new codes of all characters of the array by BitWriter.
+ *
+ * @param data Array of the characters
+ * @param length Number of the characters
+ * @param table Array of the codes of the characters
+ * @param body Array for the coded characters, they are appended to its end
+ */
+void encodeBody(const char *data, size_t length, const HuffmanCode *table, vector<char> &body){
+    BitWriter writer(body);
+    for (size_t i = 0; i < length; i++) {
+        const HuffmanCode &entry = table[(int)(unsigned char)data[i]];
+        writer.writeBits(entry.bits, entry.length);
+    }
+    writer.flush();
+}
+
+/** Function: encodeStreams
+ * Usage: encodeStreams(block.source, block.sourceLength, table, streamSizes, block.body);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function codes the array as STREAMS_NUMBER parts of the same length, only the last one could
+ * be shorter. Every part is packed by its own BitWriter, so the streams start from the whole bytes.
+ *
+ * @param data Array of the characters
+ * @param length Number of the characters
+ * @param table Codes of the characters
+ * @param streamSizes Array of STREAMS_NUMBER elements for the sizes of the streams in bytes
+ * @param body Array for the streams, they are appended to its end
+ */
+void encodeStreams(const char *data, size_t length, const HuffmanCode *table, uint64_t *streamSizes, vector<char> &body){
+    size_t partLength = (length + STREAMS_NUMBER - 1) / STREAMS_NUMBER;
+    for (int i = 0; i < STREAMS_NUMBER; i++){
+        size_t start = min(length, i * partLength);
+        size_t size = body.size();
+        encodeBody(data + start, min(partLength, length - start), table, body);
+        streamSizes[i] = body.size() - size;
+    }
+}
+
+/** Function: decodeStreams
+ * Usage: decodeStreams(next, streamSizes, table, buffer, length);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function decodes the parts of the array from their streams together. Every thread keeps its
+ * lookup tables and rebuilds them in the same memory for the next block.
+ *
+ * @param body Streams of the block one after another.
+ * @param streamSizes Sizes of STREAMS_NUMBER streams.
+ * @param table Array of the codes of the characters.
+ * @param out Buffer for the decoded characters.
+ * @param length Number of the characters in the block.
+ */
+void decodeStreams(const char *body, const uint64_t *streamSizes, const HuffmanCode *table, char *out, size_t length){
+    thread_local DecodeTable decodeTable;
+    decodeTable.build(table);
+
+    size_t partLength = (length + STREAMS_NUMBER - 1) / STREAMS_NUMBER;
+    BitReader readers[STREAMS_NUMBER] = {BitReader(nullptr, 0), BitReader(nullptr, 0), BitReader(nullptr, 0), BitReader(nullptr, 0)};
+    char *outputs[STREAMS_NUMBER];
+    size_t counts[STREAMS_NUMBER];
+    for (int i = 0; i < STREAMS_NUMBER; i++){
+        size_t start = min(length, i * partLength);
+        readers[i] = BitReader(body, streamSizes[i]);
+        body += streamSizes[i];
+        outputs[i] = out + start;
+        counts[i] = min(partLength, length - start);
+    }
+    decodeTable.decodeStreams(readers, outputs, counts);
+}
+
+/** Function: encodeAdaptive
+ * Usage: encodeAdaptive(block.source, block.sourceLength, options.maxCodeLength, block.body);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function codes characters by the model, which is rebuilt periodically from frequencies of
+ * the already coded characters. At the beginning every character has frequency 1, so all of them
+ * have codes. After every period the frequencies of the coded characters are added to the model and
+ * new codes are built, period is doubled from ADAPTIVE_FIRST_PERIOD up to ADAPTIVE_MAX_PERIOD,
+ * so the model learns fast at the beginning and then rebuilding costs almost nothing. The decoder
+ * rebuilds the same codes from the decoded characters, so the data is read only once.
+ *
+ * @param data Array of the characters
+ * @param length Number of the characters
+ * @param maxCodeLength Limit of the code length
+ * @param body Array for the coded characters, they are appended to its end
+ */
+void encodeAdaptive(const char *data, size_t length, int maxCodeLength, vector<char> &body){
+    uint64_t alphabet[BYTES_NUMBER];
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        alphabet[i] = 1;
+    }
+    HuffmanCode table[BYTES_NUMBER];
+    BitWriter writer(body);
+
+    size_t pos = 0;
+    size_t period = ADAPTIVE_FIRST_PERIOD;
+    while (pos < length){
+        size_t count = min(period, length - pos);
+        buildCodes(alphabet, maxCodeLength, table);
+        for (size_t i = pos; i < pos + count; i++){
+            const HuffmanCode &entry = table[(int)(unsigned char)data[i]];
+            writer.writeBits(entry.bits, entry.length);
+        }
+        countBytes(data + pos, count, alphabet);
+        pos += count;
+        period = min(period * 2, ADAPTIVE_MAX_PERIOD);
+    }
+    writer.flush();
+}
+
+/** Function: decodeAdaptive
+ * Usage: decodeAdaptive(next, end - next, maxCodeLength, out, length);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function decodes characters coded by encodeAdaptive. It rebuilds the model in the same
+ * periods from the decoded characters, lookup tables are built again after every rebuilding in the
+ * same memory of the thread.
+ *
+ * @param body Coded body of the block.
+ * @param bodySize Size of the body in bytes.
+ * @param maxCodeLength Limit of the code length used by the encoder.
+ * @param out Buffer for the decoded characters.
+ * @param length Number of the characters in the block.
+ */
+void decodeAdaptive(const char *body, size_t bodySize, int maxCodeLength, char *out, size_t length){
+    uint64_t alphabet[BYTES_NUMBER];
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        alphabet[i] = 1;
+    }
+    HuffmanCode table[BYTES_NUMBER];
+    BitReader reader(body, bodySize);
+    thread_local DecodeTable decodeTable;
+
+    size_t pos = 0;
+    size_t period = ADAPTIVE_FIRST_PERIOD;
+    while (pos < length){
+        size_t count = min(period, length - pos);
+        buildCodes(alphabet, maxCodeLength, table);
+        decodeTable.build(table);
+        decodeTable.decode(reader, out + pos, count);
+        countBytes(out + pos, count, alphabet);
+        pos += count;
+        period = min(period * 2, ADAPTIVE_MAX_PERIOD);
+    }
+}
+
+/** Function: encodeContext
+ * Usage: if (encodeContext(block.source, block.sourceLength, options.maxCodeLength, header, block.body))...
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function counts characters separately after every previous character, context of the first
+ * character is character 0. Context gets its own table only if the table with its code lengths is
+ * cheaper then coding the context by one table of the whole block, the rest contexts are joined and
+ * share one table. Codes are not longer then ContextDecodeTable::MAX_TABLE_CODE_LENGTH, so every
+ * table is decoded by one lookup. Header has bitmap of the contexts with own tables (highest bit of
+ * the first byte is for character 0), one byte which is 1 if shared table follows, code lengths of
+ * the shared table and code lengths of the own tables in order of their characters.
+ *
+ * @param data Array of the characters, not longer then BLOCK_SIZE
+ * @param length Number of the characters
+ * @param maxCodeLength Limit of the code length
+ * @param header String for the tables of the contexts
+ * @param body Array for the coded characters, they are appended to its end
+ * @return false if the block is not smaller with the contexts
+ */
+bool encodeContext(const char *data, size_t length, int maxCodeLength, string &header, vector<char> &body){
+    if (length == 0) return false;
+    int contextLimit = ContextDecodeTable::MAX_TABLE_CODE_LENGTH;
+    if (maxCodeLength < contextLimit) contextLimit = maxCodeLength;
+
+    /* Frequencies of the characters after every character, block is short enough for 32 bits.
+     * Array is cleared at the end, so it is zero for the next block. Cells of the short block
+     * are cleared one by one, instead of the whole array.
+     */
+    thread_local vector<uint32_t> counts(BYTES_NUMBER * BYTES_NUMBER, 0);
+    unsigned char previous = 0;
+    for (size_t i = 0; i < length; i++){
+        unsigned char ch = data[i];
+        counts[previous * BYTES_NUMBER + ch]++;
+        previous = ch;
+    }
+
+    /* One table of the whole block, which the contexts are compared with*/
+    uint64_t blockAlphabet[BYTES_NUMBER];
+    getAlphabet(data, length, blockAlphabet);
+    HuffmanCode blockTable[BYTES_NUMBER];
+    buildCodes(blockAlphabet, maxCodeLength, blockTable);
+    uint64_t blockSize = getCodeLengthsForFile(blockTable).size() + (getCodedBits(blockAlphabet, blockTable) + 7) / 8;
+    uint64_t contextBlockBits[BYTES_NUMBER] = {0};
+    uint8_t blockLengths[BYTES_NUMBER];
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        blockLengths[i] = (uint8_t)blockTable[i].length;
+    }
+    uint64_t contextTotal[BYTES_NUMBER]; // every character except the last one is a context, first one has context 0
+    copy(blockAlphabet, blockAlphabet + BYTES_NUMBER, contextTotal);
+    contextTotal[(unsigned char)data[length - 1]]--;
+    contextTotal[0]++;
+    previous = 0;
+    for (size_t i = 0; i < length; i++){
+        unsigned char ch = data[i];
+        contextBlockBits[previous] += blockLengths[ch];
+        previous = ch;
+    }
+
+    /* Own tables of the contexts, the rest ones are coded by the table of their joined frequencies*/
+    vector<HuffmanCode> ownTables;
+    int contextTable[BYTES_NUMBER];
+    string bitmap(BYTES_NUMBER / 8, '\0');
+    string ownLengths;
+    uint64_t restAlphabet[BYTES_NUMBER];
+    copy(blockAlphabet, blockAlphabet + BYTES_NUMBER, restAlphabet);
+    uint64_t bodyBits = 0;
+    for (int context = 0; context < BYTES_NUMBER; context++){
+        contextTable[context] = -1;
+
+        /* Every character takes at least one bit and its code length with the character at least
+         * two bytes, context is not checked if even this is more then coding by the table of the block
+         */
+        if (contextTotal[context] + 8 * 3 >= contextBlockBits[context]) continue;
+
+        uint64_t alphabet[BYTES_NUMBER];
+        const uint32_t *row = &counts[context * BYTES_NUMBER];
+        int used = 0;
+        for (int i = 0; i < BYTES_NUMBER; i++){
+            alphabet[i] = row[i];
+            used += (row[i] != 0);
+        }
+        if (contextTotal[context] + 8 * (1 + 2 * min(used, CODE_LIST_LIMIT)) >= contextBlockBits[context]) continue;
+        HuffmanCode table[BYTES_NUMBER];
+        buildCodes(alphabet, contextLimit, table);
+        string lengths = getCodeLengthsForFile(table);
+        uint64_t ownBits = getCodedBits(alphabet, table);
+        if (ownBits + 8 * lengths.size() < contextBlockBits[context]){
+            contextTable[context] = ownTables.size() / BYTES_NUMBER;
+            ownTables.insert(ownTables.end(), table, table + BYTES_NUMBER);
+            bitmap[context / 8] |= (char)(0x80 >> (context % 8));
+            ownLengths += lengths;
+            bodyBits += ownBits;
+            for (int i = 0; i < BYTES_NUMBER; i++){
+                restAlphabet[i] -= alphabet[i];
+            }
+        }
+    }
+    if (length < counts.size() / 8){
+        previous = 0;
+        for (size_t i = 0; i < length; i++){
+            counts[previous * BYTES_NUMBER + (unsigned char)data[i]] = 0;
+            previous = data[i];
+        }
+    } else {
+        fill(counts.begin(), counts.end(), 0);
+    }
+
+    /* Shared table of the rest contexts*/
+    HuffmanCode restTable[BYTES_NUMBER];
+    buildCodes(restAlphabet, contextLimit, restTable);
+    string restLengths = getCodeLengthsForFile(restTable);
+    bodyBits += getCodedBits(restAlphabet, restTable);
+
+    uint64_t contextSize = bitmap.size() + 1 + restLengths.size() + ownLengths.size() + (bodyBits + 7) / 8;
+    if (contextSize >= blockSize) return false;
+    header = bitmap + (char)(restLengths.empty() ? 0 : 1) + restLengths + ownLengths;
+
+    const HuffmanCode *tables[BYTES_NUMBER];
+    for (int context = 0; context < BYTES_NUMBER; context++){
+        tables[context] = (contextTable[context] < 0) ? restTable : &ownTables[contextTable[context] * BYTES_NUMBER];
+    }
+    BitWriter writer(body);
+    previous = 0;
+    for (size_t i = 0; i < length; i++){
+        unsigned char ch = data[i];
+        const HuffmanCode &entry = tables[previous][ch];
+        writer.writeBits(entry.bits, entry.length);
+        previous = ch;
+    }
+    writer.flush();
+    return true;
+}
+
+/** Function: decodeContext
+ * Usage: decodeContext(next, end, buffer, length);
+ * --------------------------------------------------------------------------------------------
+ *
+ * This function reads tables written by encodeContext, contexts without own table are decoded
+ * by the shared one. Lookup tables are kept by every thread for the next blocks.
+ *
+ * @param payload Tables of the contexts and body of the block.
+ * @param end End of the payload.
+ * @param out Buffer for the decoded characters.
+ * @param length Number of the characters in the block.
+ */
+void decodeContext(const char *payload, const char *end, char *out, size_t length){
+    thread_local ContextDecodeTable decodeTable;
+    decodeTable.clear();
+
+    const char *bitmap = payload;
+    payload += BYTES_NUMBER / 8;
+    if (payload > end) throw runtime_error("Unexpected end of the archive");
+    int hasShared = readByte(payload, end);
+    if (hasShared > 1) throw runtime_error("Archive header is corrupted");
+
+    int sharedTable = -1;
+    if (hasShared){
+        HuffmanCode table[BYTES_NUMBER];
+        readCodeLengths(payload, end, table);
+        sharedTable = decodeTable.addTable(table);
+    }
+    for (int context = 0; context < BYTES_NUMBER; context++){
+        if (bitmap[context / 8] & (0x80 >> (context % 8))){
+            HuffmanCode table[BYTES_NUMBER];
+            readCodeLengths(payload, end, table);
+            decodeTable.setContext(context, decodeTable.addTable(table));
+        } else if (sharedTable >= 0){
+            decodeTable.setContext(context, sharedTable);
+        }
+    }
+
+    BitReader reader(payload, end - payload);
+    decodeTable.decode(reader, out, length);
+}
+
+/** Function: getCodedBits
+ * Usage: uint64_t bits = getCodedBits(alphabet, table);
+ * --------------------------------------------------------------------------------------------
+ *
+ * @param alphabet Frequencies of the characters
+ * @param table Codes of the characters
+ * @return Number of bits of all characters coded by the table
+ */
+uint64_t getCodedBits(const uint64_t *alphabet, const HuffmanCode *table){
+    uint64_t bits = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        bits += alphabet[i] * table[i].length;
+    }
+    return bits;
+}
+
+/** Function: getCodeLengthsForFile
+ * Usage: string codeLengthsForFile = getCodeLengthsForFile(table);
+ * ----------------------------------------------------------------------
+ *
+ * This fuction transform lengths of the new codes to the binary format for writing
+ * in the output archive file. At first goes one byte with number of used characters minus one.
+ * If less then CODE_LIST_LIMIT characters are used, then goes pairs of bytes with character
+ * and its code length. Otherwise goes bitmap of BYTES_NUMBER bits, where bit is set for every
+ * character used in the source file (highest bit of the first byte is for character 0), and
+ * one byte with code length for every used character. Empty file has no code lengths at all.
+ * Canonical codes could be restored from this lengths, so frequencies are not needed.
+ *
+ * @param table array of new codes of the characters
+ * @return Code lengths in binary string.
+ */
+string getCodeLengthsForFile(const HuffmanCode *table){
+    string bitmap(BYTES_NUMBER / 8, '\0');
+    string pairs;
+    string lengths;
+    int used = 0;
+    for(int i = 0; i < BYTES_NUMBER; i++){
+        if(table[i].length != 0){
+            bitmap[i / 8] |= (char)(0x80 >> (i % 8));
+            pairs += (char)i;
+            pairs += (char)table[i].length;
+            lengths += (char)table[i].length;
+            used++;
+        }
+    }
+
+    if (used == 0) return "";
+    string result(1, (char)(used - 1));
+    return (used < CODE_LIST_LIMIT) ? result + pairs : result + bitmap + lengths;
+}
+
+/**
+ * Function: readCodeLengths
+ * Usage: readCodeLengths(next, end, table);
+ * -----------------------------------------------------------------------------
+ * This function read list or bitmap of the used characters and lengths of their codes,
+ * written by getCodeLengthsForFile, and assign canonical codes to the characters. Lengths which
+ * leave part of the code space unused are rejected, except the code of the single character.
+ *
+ * @param data Pointer to the code lengths, moved to the next byte after them.
+ * @param end End of the data.
+ * @param table Array for the restored codes.
+ */
+void readCodeLengths(const char *&data, const char *end, HuffmanCode *table){
+    int used = readByte(data, end) + 1;
+    if (used < CODE_LIST_LIMIT){
+        for (int i = 0; i < used; i++){
+            int ch = readByte(data, end);
+            table[ch].length = readByte(data, end);
+        }
+    } else {
+        const char *bitmap = data;
+        data += BYTES_NUMBER / 8;
+        if (data > end) throw runtime_error("Unexpected end of the archive");
+        for (int i = 0; i < BYTES_NUMBER; i++){
+            if (bitmap[i / 8] & (0x80 >> (i % 8))){
+                table[i].length = readByte(data, end);
+            }
+        }
+    }
+    if (!assignCanonicalCodes(table)){
+        throw runtime_error("Archive header is corrupted");
+    }
+
+    /* Codes should fill the whole code space, so every bit sequence of the body is a code of some
+     * character. Only the code of the single character is allowed to leave a half of it free.*/
+    uint64_t space = 0;
+    int count = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (table[i].length != 0){
+            space += (uint64_t)1 << (MAX_CODE_LENGTH - table[i].length);
+            count++;
+        }
+    }
+    if (count > 1 && space != (uint64_t)1 << MAX_CODE_LENGTH){
+        throw runtime_error("Archive header is corrupted");
+    }
+}
+/**
+ * Function: decodeBlock
+ * Usage: decodeBlock(next, end - next, table, buffer.data(), length);
+ * -------------------------------------------------------------------------------------
+ *
+ * This function decoding one block of the archive file. It receive coded body of the block,
+ * canonical codes of the characters for decoding and length of the block. Body is read by
+ * BitReader and decoded by lookup tables built from the codes, several bits at once. Every
+ * thread keeps its lookup tables and rebuilds them in the same memory for the next block.
+ *
+ * @param body Coded body of the block.
+ * @param bodySize Size of the body in bytes.
+ * @param table Array of the codes of the characters.
+ * @param out Buffer for the decoded characters.
+ * @param length Number of the characters in the block.
+ */
+void decodeBlock(const char *body, size_t bodySize, const HuffmanCode *table, char *out, size_t length){
+    thread_local DecodeTable decodeTable;
+    decodeTable.build(table);
+    decodeBlock(body, bodySize, decodeTable, out, length);
+}
+
+/**
+ * Function: decodeBlock
+ * Usage: decodeBlock(next, end - next, sharedTable->decodeTable, buffer, length);
+ * -------------------------------------------------------------------------------------
+ *
+ * This function decodes one block by lookup tables built before, so tables of the shared
+ * code table are built only once for all blocks.
+ *
+ * @param body Coded body of the block.
+ * @param bodySize Size of the body in bytes.
+ * @param decodeTable Lookup tables built from the codes of the block.
+ * @param out Buffer for the decoded characters.
+ * @param length Number of the characters in the block.
+ */
+void decodeBlock(const char *body, size_t bodySize, const DecodeTable &decodeTable, char *out, size_t length){
+    BitReader reader(body, bodySize);
+    decodeTable.decode(reader, out, length);
+}
+
+/**
+ * Function: readByte
+ * Usage: int byte = readByte(next, end);
+ * -----------------------------------------------
+ * This function reads one byte and checks that it is not after the end of the data.
+ *
+ * @param data Pointer to the byte, moved to the next byte.
+ * @param end End of the data.
+ * @return Value of the byte from 0 to 255
+ */
+int readByte(const char *&data, const char *end){
+    if (data >= end) throw runtime_error("Unexpected end of the archive");
+    return (unsigned char)*data++;
+}
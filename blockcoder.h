@@ -0,0 +1,166 @@
+/* File: blockcoder.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports stages of coding one block of the file by Huffman's
+ * algorithm and format of the code lengths stored with every block.
+ */
+
+#ifndef BLOCKCODER_H
+#define BLOCKCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "codetable.h"
+
+/* Number of the source file characters coded with one table*/
+const int BLOCK_SIZE = 1 << 20;
+
+/* Default limit of the code length*/
+const int DEFAULT_MAX_CODE_LENGTH = 15;
+
+/* Methods of coding the block, stored in the first byte of the block*/
+const int HUFFMAN_BLOCK = 0; // code lengths of the block go before the body
+const int ADAPTIVE_BLOCK = 1; // limit of the code length goes before the body coded by the adaptive model
+const int SHARED_TABLE_BLOCK = 2; // number of the shared code table goes before the body
+const int CONTEXT_BLOCK = 3; // code tables chosen by the previous character go before the body
+const int INTERLEAVED_BLOCK = 4; // code lengths and sizes of the streams go before the streams of the body
+const int STORED_BLOCK = 5; // characters are stored without coding
+const int RUN_BLOCK = 6; // the only character repeated by the whole block
+
+/* Number of the streams of the interleaved block*/
+const int STREAMS_NUMBER = DecodeTable::STREAMS_NUMBER;
+
+/* Function: getAlphabet
+ * Usage: getAlphabet(data, length, alphabet);
+ * --------------------------------------------------------------
+ * Fills array of BYTES_NUMBER elements with frequencies of the
+ * characters in the received array.
+ */
+void getAlphabet(const char *data, size_t length, uint64_t *alphabet);
+
+/* Function: getSampledAlphabet
+ * Usage: getSampledAlphabet(data, length, alphabet);
+ * --------------------------------------------------------------
+ * Fills array of BYTES_NUMBER elements with frequencies of the characters
+ * estimated by the part of the received array. Every character gets
+ * frequency not less then 1, so all of them could be coded. Short arrays
+ * are counted completely.
+ */
+void getSampledAlphabet(const char *data, size_t length, uint64_t *alphabet);
+
+/* Function: estimateCodedSize
+ * Usage: uint64_t size = estimateCodedSize(alphabet, length);
+ * --------------------------------------------------------------
+ * Returns size in bytes of the code lengths and the body of "length"
+ * characters estimated by the entropy of the frequencies, which could be
+ * counted by the sample. Static order-0 Huffman's codes are never shorter
+ * then this entropy, adaptive and order-1 codes could be shorter.
+ */
+uint64_t estimateCodedSize(const uint64_t *alphabet, size_t length);
+
+/* Function: buildCodes
+ * Usage: buildCodes(alphabet, maxCodeLength, table);
+ * --------------------------------------------------------------
+ * Builds canonical Huffman codes of BYTES_NUMBER characters from their
+ * frequencies. No code is longer then maxCodeLength bits, unused
+ * characters get codes of zero length.
+ */
+void buildCodes(const uint64_t *alphabet, int maxCodeLength, HuffmanCode *table);
+
+/* Function: encodeBody
+ * Usage: encodeBody(data, length, table, body);
+ * --------------------------------------------------------------
+ * Appends codes of all characters of the received array to the body.
+ */
+void encodeBody(const char *data, size_t length, const HuffmanCode *table, std::vector<char> &body);
+
+/* Function: encodeStreams
+ * Usage: encodeStreams(data, length, table, streamSizes, body);
+ * --------------------------------------------------------------
+ * Divides the array into STREAMS_NUMBER parts and appends every part
+ * coded by the table to the body as separate stream. Sizes of the
+ * streams are saved to the array.
+ */
+void encodeStreams(const char *data, size_t length, const HuffmanCode *table, uint64_t *streamSizes, std::vector<char> &body);
+
+/* Function: decodeStreams
+ * Usage: decodeStreams(body, streamSizes, table, out, length);
+ * --------------------------------------------------------------
+ * Decodes "length" characters from the streams written by encodeStreams.
+ */
+void decodeStreams(const char *body, const uint64_t *streamSizes, const HuffmanCode *table, char *out, size_t length);
+
+/* Function: encodeAdaptive
+ * Usage: encodeAdaptive(data, length, maxCodeLength, body);
+ * --------------------------------------------------------------
+ * Appends characters of the received array to the body coded by the
+ * adaptive model, which is updated by already coded characters, so
+ * no code lengths are needed for decoding.
+ */
+void encodeAdaptive(const char *data, size_t length, int maxCodeLength, std::vector<char> &body);
+
+/* Function: decodeAdaptive
+ * Usage: decodeAdaptive(body, bodySize, maxCodeLength, out, length);
+ * --------------------------------------------------------------
+ * Decodes "length" characters coded by encodeAdaptive to the output buffer.
+ */
+void decodeAdaptive(const char *body, size_t bodySize, int maxCodeLength, char *out, size_t length);
+
+/* Function: encodeContext
+ * Usage: if (encodeContext(data, length, maxCodeLength, header, body))...
+ * --------------------------------------------------------------
+ * Codes every character by the code table of the previous character.
+ * Writes tables of the contexts to the header and appends coded characters
+ * to the body. Returns false and writes nothing if the block is not smaller
+ * then coded by one table.
+ */
+bool encodeContext(const char *data, size_t length, int maxCodeLength, std::string &header, std::vector<char> &body);
+
+/* Function: decodeContext
+ * Usage: decodeContext(payload, end, out, length);
+ * --------------------------------------------------------------
+ * Reads tables of the contexts written by encodeContext and decodes
+ * "length" characters of the body after them to the output buffer.
+ */
+void decodeContext(const char *payload, const char *end, char *out, size_t length);
+
+/* Function: getCodeLengthsForFile
+ * Usage: string codeLengths = getCodeLengthsForFile(table);
+ * --------------------------------------------------------------
+ * Returns lengths of the codes in binary format stored in the archive.
+ */
+std::string getCodeLengthsForFile(const HuffmanCode *table);
+
+/* Function: readCodeLengths
+ * Usage: readCodeLengths(next, end, table);
+ * --------------------------------------------------------------
+ * Reads code lengths written by getCodeLengthsForFile and restores
+ * canonical codes of the characters from them.
+ */
+void readCodeLengths(const char *&data, const char *end, HuffmanCode *table);
+
+/* Function: decodeBlock
+ * Usage: decodeBlock(body, bodySize, table, out, length);
+ * --------------------------------------------------------------
+ * Decodes "length" characters from the coded body to the output buffer.
+ */
+void decodeBlock(const char *body, size_t bodySize, const HuffmanCode *table, char *out, size_t length);
+
+/* Function: decodeBlock
+ * Usage: decodeBlock(body, bodySize, decodeTable, out, length);
+ * --------------------------------------------------------------
+ * Decodes "length" characters by already built lookup tables.
+ */
+void decodeBlock(const char *body, size_t bodySize, const DecodeTable &decodeTable, char *out, size_t length);
+
+/* Function: readByte
+ * Usage: int byte = readByte(next, end);
+ * --------------------------------------------------------------
+ * Reads one byte of the archive, throws an exception after the end of the data.
+ */
+int readByte(const char *&data, const char *end);
+
+#endif // BLOCKCODER_H
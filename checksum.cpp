@@ -0,0 +1,103 @@
+/* File: checksum.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements CRC32C checksum. Processors with SSE 4.2 compute it by the instruction
+ * "crc32" for eight bytes at once. Other processors use eight tables, one for every byte of the
+ * 64-bit word ("slicing by 8"), so every word is added by eight independent lookups.
+ */
+
+#include <cstring>
+
+#include "checksum.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define CHECKSUM_X86_DISPATCH
+#include <nmmintrin.h>
+#endif
+
+namespace {
+
+const uint32_t POLYNOMIAL = 0x82F63B78; // reversed polynomial of CRC32C
+const int TABLES_NUMBER = 8;
+const int VALUES_NUMBER = 256;
+
+struct Tables {
+    uint32_t values[TABLES_NUMBER][VALUES_NUMBER];
+};
+
+/* Builds tables, first table is the checksum of one byte, every next one is the
+ * checksum of the same byte followed by one more zero byte*/
+Tables buildTables(){
+    Tables tables;
+    for (int value = 0; value < VALUES_NUMBER; value++){
+        uint32_t crc = value;
+        for (int bit = 0; bit < 8; bit++){
+            crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+        }
+        tables.values[0][value] = crc;
+    }
+    for (int value = 0; value < VALUES_NUMBER; value++){
+        for (int table = 1; table < TABLES_NUMBER; table++){
+            uint32_t crc = tables.values[table - 1][value];
+            tables.values[table][value] = (crc >> 8) ^ tables.values[0][crc & 0xFF];
+        }
+    }
+    return tables;
+}
+
+uint32_t crcScalar(const unsigned char *data, size_t length, uint32_t crc){
+    static const Tables tables = buildTables();
+    const uint32_t (*values)[VALUES_NUMBER] = tables.values;
+    size_t pos = 0;
+    for (; pos + 8 <= length; pos += 8){
+        uint64_t word;
+        memcpy(&word, data + pos, sizeof(word));
+        word ^= crc; // bytes of the word are taken from the lowest one
+        crc = values[7][word & 0xFF] ^ values[6][(word >> 8) & 0xFF] ^
+              values[5][(word >> 16) & 0xFF] ^ values[4][(word >> 24) & 0xFF] ^
+              values[3][(word >> 32) & 0xFF] ^ values[2][(word >> 40) & 0xFF] ^
+              values[1][(word >> 48) & 0xFF] ^ values[0][word >> 56];
+    }
+    for (; pos < length; pos++){
+        crc = (crc >> 8) ^ values[0][(crc ^ data[pos]) & 0xFF];
+    }
+    return crc;
+}
+
+#ifdef CHECKSUM_X86_DISPATCH
+
+__attribute__((target("sse4.2")))
+uint32_t crcSse42(const unsigned char *data, size_t length, uint32_t crc){
+    uint64_t crc64 = crc;
+    size_t pos = 0;
+    for (; pos + 8 <= length; pos += 8){
+        uint64_t word;
+        memcpy(&word, data + pos, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (uint32_t)crc64;
+    for (; pos < length; pos++){
+        crc = _mm_crc32_u8(crc, data[pos]);
+    }
+    return crc;
+}
+
+#endif
+
+typedef uint32_t (*CrcFunction)(const unsigned char *data, size_t length, uint32_t crc);
+
+/* Chooses the best implementation for the current processor*/
+CrcFunction chooseKernel(){
+#ifdef CHECKSUM_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse4.2")) return crcSse42;
+#endif
+    return crcScalar;
+}
+
+}
+
+uint32_t crc32c(const char *data, size_t length, uint32_t previous){
+    static const CrcFunction function = chooseKernel();
+    return ~function((const unsigned char*)data, length, ~previous);
+}
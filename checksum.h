@@ -0,0 +1,23 @@
+/* File: checksum.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports CRC32C checksum, stored with every block of the
+ * archive for checking the decoded data.
+ */
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Function: crc32c
+ * Usage: uint32_t checksum = crc32c(data, length);
+ * --------------------------------------------------------------
+ * Returns CRC32C (Castagnoli) checksum of the array. Checksum of the
+ * next part of the data is continued from the checksum of the previous
+ * parts. Instructions of SSE 4.2 are used if the processor has them.
+ */
+uint32_t crc32c(const char *data, size_t length, uint32_t previous = 0);
+
+#endif // CHECKSUM_H
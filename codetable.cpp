@@ -0,0 +1,405 @@
+/* File: codetable.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements lookup tables for decoding the archive body.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "codetable.h"
+
+using namespace std;
+
+/** Function: assignCanonicalCodes
+ * Usage: if (assignCanonicalCodes(codes))...
+ * ------------------------------------------------------------------------------------
+ *
+ * This function counts number of codes of every length and calculates first code of every
+ * length: it equals to the next code after the last code of previous length, extended by one
+ * zero bit. Then it goes through characters in order and gives them next free code of their length.
+ *
+ * @param codes Array of the codes with filled lengths, unused characters have zero length
+ * @return false if some length is too long or there are too many codes of some length.
+ */
+bool assignCanonicalCodes(HuffmanCode *codes){
+    int lengthCount[MAX_CODE_LENGTH + 1] = {0};
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (codes[i].length < 0 || codes[i].length > MAX_CODE_LENGTH) return false;
+        lengthCount[codes[i].length]++;
+    }
+    lengthCount[0] = 0;
+
+    uint64_t nextCode[MAX_CODE_LENGTH + 1];
+    uint64_t code = 0;
+    for (int length = 1; length <= MAX_CODE_LENGTH; length++){
+        code = (code + lengthCount[length - 1]) << 1;
+        nextCode[length] = code;
+        if (lengthCount[length] != 0 && ((code + lengthCount[length] - 1) >> length) != 0) return false;
+    }
+
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (codes[i].length != 0){
+            codes[i].bits = nextCode[codes[i].length]++;
+        }
+    }
+    return true;
+}
+
+/** Function: limitCodeLengths
+ * Usage: limitCodeLengths(codes, alphabet, maxLength);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function works with number of codes of every length. While there are codes longer then
+ * maxLength, it takes two deepest leaves, which are brothers in the tree, moves one of them
+ * to their parent place and the second one becomes brother of some leaf from the nearest level
+ * above: this leaf goes one level down together with the new brother. Number of codes and
+ * prefix property are kept, only the encoded body becomes a little longer.
+ * After this characters sorted by frequency get new lengths, most frequent goes first.
+ *
+ * @param codes Array of the codes with lengths from the Huffman tree
+ * @param frequencies Frequencies of the characters
+ * @param maxLength Maximal length of the code, not less then MIN_CODE_LENGTH_LIMIT
+ */
+void limitCodeLengths(HuffmanCode *codes, const uint64_t *frequencies, int maxLength){
+    if (maxLength < MIN_CODE_LENGTH_LIMIT) throw runtime_error("Limit of the code length is too small for all characters");
+    int lengthCount[MAX_CODE_LENGTH + 1] = {0};
+    int longest = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (codes[i].length != 0){
+            lengthCount[codes[i].length]++;
+            longest = max(longest, codes[i].length);
+        }
+    }
+    if (longest <= maxLength) return;
+
+    for (int length = longest; length > maxLength; length--){
+        while (lengthCount[length] > 0){
+            int upper = length - 2;
+            while (lengthCount[upper] == 0) upper--;
+            lengthCount[length] -= 2;
+            lengthCount[length - 1]++;
+            lengthCount[upper + 1] += 2;
+            lengthCount[upper]--;
+        }
+    }
+
+    /* Used characters from the most frequent to the least*/
+    int characters[BYTES_NUMBER];
+    int used = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (codes[i].length != 0) characters[used++] = i;
+    }
+    sort(characters, characters + used, [frequencies](int a, int b){
+        return frequencies[a] > frequencies[b] || (frequencies[a] == frequencies[b] && a < b);
+    });
+
+    int next = 0;
+    for (int length = 1; length <= maxLength; length++){
+        for (int i = 0; i < lengthCount[length]; i++){
+            codes[characters[next++]].length = length;
+        }
+    }
+}
+
+DecodeTable::DecodeTable(){
+    useTables = true;
+    maxLength = 0;
+}
+
+/** Method: build
+ * Usage: if (table.build(codes))...
+ * ------------------------------------------------------------------------------------
+ *
+ * At the begining every code not longer then FIRST_LEVEL_BITS fills all first level entries,
+ * which index starts with this code. Longer codes are grouped by their first FIRST_LEVEL_BITS
+ * bits, every group gets own second level table with size enough for the longest code in it.
+ * At the end entries with short codes are joined with the next code, if both of them fit
+ * in FIRST_LEVEL_BITS bits, so one lookup gives two characters.
+ * If the longest code does not fit in two levels, only ranges of the canonical codes
+ * of every length are prepared for decoding bit by bit.
+ *
+ * @param codes Array of the canonical codes, unused characters have zero length
+ */
+void DecodeTable::build(const HuffmanCode *codes){
+    const int firstSize = 1 << FIRST_LEVEL_BITS;
+
+    /* Ranges of the canonical codes, characters are sorted by lengths of their codes*/
+    maxLength = 0;
+    for (int length = 0; length <= MAX_CODE_LENGTH; length++){
+        firstCode[length] = 0;
+        lengthCount[length] = 0;
+    }
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (codes[i].length != 0){
+            lengthCount[codes[i].length]++;
+            maxLength = max(maxLength, codes[i].length);
+        }
+    }
+    int nextIndex[MAX_CODE_LENGTH + 1];
+    int position = 0;
+    for (int length = 0; length <= MAX_CODE_LENGTH; length++){
+        firstIndex[length] = nextIndex[length] = position;
+        position += lengthCount[length];
+    }
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        int length = codes[i].length;
+        if (length == 0) continue;
+        if (nextIndex[length] == firstIndex[length]) firstCode[length] = codes[i].bits;
+        sortedCharacters[nextIndex[length]++] = (uint8_t)i;
+    }
+    useTables = (maxLength <= MAX_TABLE_CODE_LENGTH);
+    if (!useTables) return;
+
+    Entry empty = {0, 0, 0, 0};
+    firstLevel.assign(firstSize, empty);
+    secondLevel.clear();
+
+    /* Length of the second level table index for every prefix of the long codes*/
+    fill(subBits, subBits + firstSize, 0);
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        const HuffmanCode &code = codes[i];
+        if (code.length > FIRST_LEVEL_BITS){
+            int extra = code.length - FIRST_LEVEL_BITS;
+            int prefix = (int)(code.bits >> extra);
+            if (extra > subBits[prefix]) subBits[prefix] = extra;
+        }
+    }
+
+    /* Links to the second level tables*/
+    for (int prefix = 0; prefix < firstSize; prefix++){
+        if (subBits[prefix] != 0){
+            Entry link = {(uint32_t)secondLevel.size(), (uint8_t)subBits[prefix], 0, 0};
+            firstLevel[prefix] = link;
+            secondLevel.resize(secondLevel.size() + (1 << subBits[prefix]), empty);
+        }
+    }
+
+    /* Characters*/
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        const HuffmanCode &code = codes[i];
+        if (code.length == 0) continue;
+
+        Entry entry = {(uint32_t)i, (uint8_t)code.length, 1, (uint8_t)code.length};
+        if (code.length <= FIRST_LEVEL_BITS){
+            int freeBits = FIRST_LEVEL_BITS - code.length;
+            int start = (int)(code.bits << freeBits);
+            for (int j = 0; j < (1 << freeBits); j++){
+                firstLevel[start + j] = entry;
+            }
+        } else {
+            int extra = code.length - FIRST_LEVEL_BITS;
+            const Entry &link = firstLevel[(int)(code.bits >> extra)];
+            int freeBits = link.length - extra;
+            int start = link.value + (int)((code.bits & ((1u << extra) - 1)) << freeBits);
+            for (int j = 0; j < (1 << freeBits); j++){
+                secondLevel[start + j] = entry;
+            }
+        }
+    }
+
+    /* Joining pairs of short codes*/
+    singleLevel.assign(firstLevel.begin(), firstLevel.end());
+    const Entry *single = singleLevel.data();
+    for (int index = 0; index < firstSize; index++){
+        const Entry &first = single[index];
+        if (first.count != 1 || first.length >= FIRST_LEVEL_BITS) continue;
+
+        const Entry &second = single[(index << first.length) & (firstSize - 1)];
+        if (second.count == 1 && first.length + second.length <= FIRST_LEVEL_BITS){
+            Entry pair = {first.value | (second.value << 8), (uint8_t)(first.length + second.length), 2, first.length};
+            firstLevel[index] = pair;
+        }
+    }
+}
+
+/** Method: decode
+ * Usage: table.decode(reader, buffer, count);
+ * ------------------------------------------------------------------------------------
+ *
+ * Main decoding loop. Every iteration refills the reader and makes one lookup in the
+ * first level table, what gives one or two characters. Links to second level tables
+ * need one more lookup with longer index. Last character is decoded separately
+ * to avoid writing second character of the pair after the end of the buffer.
+ * Throws runtime_error if the body contains bits, what are not a code of any character.
+ *
+ * @param reader Reader of the archive body
+ * @param out Output buffer
+ * @param count Number of characters to decode
+ */
+void DecodeTable::decode(BitReader &reader, char *out, size_t count) const{
+    if (!useTables){
+        decodeSlow(reader, out, count);
+        return;
+    }
+
+    const Entry *first = firstLevel.data();
+    const Entry *second = secondLevel.data();
+    size_t pos = 0;
+
+    while (pos < count){
+        reader.refill();
+        Entry entry = first[reader.peekBits(FIRST_LEVEL_BITS)];
+        if (entry.count == 0){
+            if (entry.length == 0) throw runtime_error("Archive body is corrupted");
+            uint32_t index = reader.peekBits(FIRST_LEVEL_BITS + entry.length) & ((1u << entry.length) - 1);
+            entry = second[entry.value + index];
+            if (entry.count == 0) throw runtime_error("Archive body is corrupted");
+        }
+
+        if (entry.count == 2 && pos + 1 < count){
+            out[pos] = (char)entry.value;
+            out[pos + 1] = (char)(entry.value >> 8);
+            pos += 2;
+            reader.skipBits(entry.length);
+        } else {
+            out[pos] = (char)entry.value;
+            pos++;
+            reader.skipBits(entry.firstLength);
+        }
+    }
+}
+
+inline int DecodeTable::decodeNext(BitReader &reader, char *out) const{
+    reader.refill();
+    Entry entry = firstLevel[reader.peekBits(FIRST_LEVEL_BITS)];
+    if (entry.count == 0){
+        if (entry.length == 0) throw runtime_error("Archive body is corrupted");
+        uint32_t index = reader.peekBits(FIRST_LEVEL_BITS + entry.length) & ((1u << entry.length) - 1);
+        entry = secondLevel[entry.value + index];
+        if (entry.count == 0) throw runtime_error("Archive body is corrupted");
+    }
+    out[0] = (char)entry.value;
+    out[1] = (char)(entry.value >> 8);
+    reader.skipBits(entry.length);
+    return entry.count;
+}
+
+/** Method: decodeStreams
+ * Usage: table.decodeStreams(readers, outputs, counts);
+ * ------------------------------------------------------------------------------------
+ *
+ * While every stream has at least two characters left, each step decodes next characters of all
+ * streams. Streams have their own readers and outputs, so lookups of the different streams do not
+ * wait for each other. Last characters of every stream are decoded by decode.
+ *
+ * @param readers STREAMS_NUMBER readers of the streams
+ * @param outputs Output buffers of the streams
+ * @param counts Number of characters in every stream
+ */
+void DecodeTable::decodeStreams(BitReader *readers, char *const *outputs, const size_t *counts) const{
+    size_t pos[STREAMS_NUMBER] = {0};
+    if (useTables){
+        while (pos[0] + 1 < counts[0] && pos[1] + 1 < counts[1] && pos[2] + 1 < counts[2] && pos[3] + 1 < counts[3]){
+            pos[0] += decodeNext(readers[0], outputs[0] + pos[0]);
+            pos[1] += decodeNext(readers[1], outputs[1] + pos[1]);
+            pos[2] += decodeNext(readers[2], outputs[2] + pos[2]);
+            pos[3] += decodeNext(readers[3], outputs[3] + pos[3]);
+        }
+    }
+    for (int i = 0; i < STREAMS_NUMBER; i++){
+        decode(readers[i], outputs[i] + pos[i], counts[i] - pos[i]);
+    }
+}
+
+/** Method: decodeSlow
+ * Usage: decodeSlow(reader, buffer, count);
+ * ------------------------------------------------------------------------------------
+ *
+ * Reads code of the character bit by bit. After every bit it checks if the code is in range of
+ * canonical codes of current length, in this case character is found by its position in the range.
+ *
+ * @param reader Reader of the archive body
+ * @param out Output buffer
+ * @param count Number of characters to decode
+ */
+void DecodeTable::decodeSlow(BitReader &reader, char *out, size_t count) const{
+    for (size_t pos = 0; pos < count; pos++){
+        uint64_t code = 0;
+        int length = 0;
+        while (true){
+            if (length == maxLength) throw runtime_error("Archive body is corrupted");
+            reader.refill();
+            code = (code << 1) | reader.peekBits(1);
+            reader.skipBits(1);
+            length++;
+            if (code - firstCode[length] < (uint64_t)lengthCount[length]){
+                out[pos] = (char)sortedCharacters[firstIndex[length] + (int)(code - firstCode[length])];
+                break;
+            }
+        }
+    }
+}
+
+ContextDecodeTable::ContextDecodeTable(){
+    clear();
+}
+
+void ContextDecodeTable::clear(){
+    entries.clear();
+    tables.clear();
+    Table empty = {0, 0};
+    fill(contexts, contexts + BYTES_NUMBER, empty);
+}
+
+/** Method: addTable
+ * Usage: int index = table.addTable(codes);
+ * ------------------------------------------------------------------------------------
+ *
+ * Every code fills all entries of the new lookup table, which index starts with this code.
+ *
+ * @param codes Array of the canonical codes, unused characters have zero length
+ * @return Index of the added table
+ */
+int ContextDecodeTable::addTable(const HuffmanCode *codes){
+    int bits = 0;
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        bits = max(bits, codes[i].length);
+    }
+    if (bits == 0 || bits > MAX_TABLE_CODE_LENGTH) throw runtime_error("Archive header is corrupted");
+
+    Table table = {(uint32_t)entries.size(), (uint8_t)bits};
+    Entry empty = {0, 0};
+    entries.resize(entries.size() + (1 << bits), empty);
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        const HuffmanCode &code = codes[i];
+        if (code.length == 0) continue;
+        Entry entry = {(uint8_t)i, (uint8_t)code.length};
+        int freeBits = bits - code.length;
+        uint32_t start = table.offset + (uint32_t)(code.bits << freeBits);
+        fill(entries.begin() + start, entries.begin() + start + (1 << freeBits), entry);
+    }
+    tables.push_back(table);
+    return tables.size() - 1;
+}
+
+void ContextDecodeTable::setContext(int context, int table){
+    contexts[context] = tables[table];
+}
+
+/** Method: decode
+ * Usage: table.decode(reader, buffer, count);
+ * ------------------------------------------------------------------------------------
+ *
+ * Every iteration refills the reader and makes one lookup in the table of the previous
+ * character. Throws runtime_error if the previous character has no table or the body
+ * contains bits, what are not a code of any character.
+ *
+ * @param reader Reader of the archive body
+ * @param out Output buffer
+ * @param count Number of characters to decode
+ */
+void ContextDecodeTable::decode(BitReader &reader, char *out, size_t count) const{
+    const Entry *base = entries.data();
+    unsigned char previous = 0;
+    for (size_t pos = 0; pos < count; pos++){
+        reader.refill();
+        const Table &table = contexts[previous];
+        if (table.bits == 0) throw runtime_error("Archive body is corrupted");
+        Entry entry = base[table.offset + reader.peekBits(table.bits)];
+        if (entry.length == 0) throw runtime_error("Archive body is corrupted");
+        out[pos] = (char)entry.value;
+        reader.skipBits(entry.length);
+        previous = entry.value;
+    }
+}
@@ -0,0 +1,225 @@
+/* File: codetable.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports structures for storing new codes of the characters,
+ * functions for building canonical Huffman codes and the lookup table
+ * used for fast decoding of the archive body.
+ */
+
+#ifndef CODETABLE_H
+#define CODETABLE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "bitstream.h"
+
+const int BYTES_NUMBER = 256;
+
+/* Maximal length of the code, which could be stored in the archive*/
+const int MAX_CODE_LENGTH = 63;
+
+/* Shortest limit of the code length, with which all characters still get their codes*/
+const int MIN_CODE_LENGTH_LIMIT = 8;
+
+/* Structure to save new code of the character*/
+struct HuffmanCode {
+    uint64_t bits = 0; // code bits stored in lowest "length" bits
+    int length = 0;
+};
+
+/* Function: assignCanonicalCodes
+ * Usage: if (assignCanonicalCodes(codes))...
+ * --------------------------------------------------------------
+ * Replaces bits of BYTES_NUMBER codes with canonical Huffman codes
+ * of the same lengths. Shorter codes go first and codes of the same
+ * length are ordered by characters, so codes could be restored from
+ * their lengths only. Returns false if lengths do not describe
+ * a prefix code.
+ */
+bool assignCanonicalCodes(HuffmanCode *codes);
+
+/* Function: limitCodeLengths
+ * Usage: limitCodeLengths(codes, alphabet, maxLength);
+ * --------------------------------------------------------------
+ * Shortens lengths of BYTES_NUMBER codes built from the Huffman tree,
+ * so no code is longer then maxLength bits. Lengths are redistributed
+ * between characters according to their frequencies. Throws an exception
+ * if maxLength is less then MIN_CODE_LENGTH_LIMIT.
+ */
+void limitCodeLengths(HuffmanCode *codes, const uint64_t *frequencies, int maxLength);
+
+/* Class: DecodeTable
+ * --------------------------------------------------------------
+ *
+ * This class decodes archive body by lookup tables instead of walking the
+ * binary tree bit by bit. First level table is indexed by next FIRST_LEVEL_BITS
+ * bits of the stream, every its entry contains one or two decoded characters
+ * and number of bits used by them. Codes longer then FIRST_LEVEL_BITS are
+ * resolved by the second level table linked from the first level entry.
+ * Codes are expected to be canonical, if some of them are longer then
+ * MAX_TABLE_CODE_LENGTH all characters are decoded bit by bit.
+ */
+class DecodeTable{
+
+public:
+
+    /* Number of bits used for indexing first level table*/
+    static const int FIRST_LEVEL_BITS = 11;
+
+    /* Maximal code length supported by two level table*/
+    static const int MAX_TABLE_CODE_LENGTH = 2 * FIRST_LEVEL_BITS;
+
+    /* Number of the streams decoded together by decodeStreams*/
+    static const int STREAMS_NUMBER = 4;
+
+    /* Constructor: DecodeTable
+     * Usage: DecodeTable table;
+     * -----------------------------------------------------
+     * Initializes a new empty table
+     */
+    DecodeTable();
+
+    /* Method: build
+     * Usage: table.build(codes);
+     * -----------------------------------------------------
+     * Fills lookup tables from array of BYTES_NUMBER canonical codes.
+     */
+    void build(const HuffmanCode *codes);
+
+    /* Method: decode
+     * Usage: table.decode(reader, buffer, count);
+     * -----------------------------------------------------
+     * Decodes "count" characters from the reader to the output buffer.
+     */
+    void decode(BitReader &reader, char *out, size_t count) const;
+
+    /* Method: decodeStreams
+     * Usage: table.decodeStreams(readers, outputs, counts);
+     * -----------------------------------------------------
+     * Decodes STREAMS_NUMBER independent streams coded by the same
+     * codes, next characters of every stream at each step, so the
+     * processor could work on several streams at once.
+     */
+    void decodeStreams(BitReader *readers, char *const *outputs, const size_t *counts) const;
+
+private:
+
+    /* Entry of the lookup table. If count is 0, entry is a link to the
+     * second level table, which starts from "value" and indexed by "length" bits.
+     */
+    struct Entry {
+        uint32_t value;   // decoded characters, first one in lowest byte
+        uint8_t length;   // number of bits used by all decoded characters
+        uint8_t count;    // number of decoded characters
+        uint8_t firstLength; // number of bits used by first character
+    };
+
+    /* Tables are rebuilt in the same memory, so the table used for a lot of
+     * blocks allocates nothing after the first build
+     */
+    std::vector<Entry> firstLevel;
+    std::vector<Entry> secondLevel;
+    std::vector<Entry> singleLevel; // first level before joining pairs of codes
+    uint8_t subBits[1 << FIRST_LEVEL_BITS]; // index length of the second level table for every prefix
+
+    /* Data for decoding bit by bit*/
+    bool useTables;
+    int maxLength;
+    uint8_t sortedCharacters[BYTES_NUMBER]; // characters ordered by their codes
+    uint64_t firstCode[MAX_CODE_LENGTH + 1]; // first canonical code of every length
+    int firstIndex[MAX_CODE_LENGTH + 1]; // position of this code in sortedCharacters
+    int lengthCount[MAX_CODE_LENGTH + 1]; // number of codes of every length
+
+    /* Method: decodeSlow
+     * Usage: decodeSlow(reader, buffer, count);
+     * ------------------------------------------------
+     * Decodes characters bit by bit using canonical
+     * codes ranges for every length.
+     */
+    void decodeSlow(BitReader &reader, char *out, size_t count) const;
+
+    /* Method: decodeNext
+     * Usage: out += decodeNext(reader, out);
+     * ------------------------------------------------
+     * Decodes one or two next characters by the tables,
+     * at least two places should be free in the buffer.
+     */
+    int decodeNext(BitReader &reader, char *out) const;
+};
+
+/* Class: ContextDecodeTable
+ * --------------------------------------------------------------
+ *
+ * This class decodes characters coded by several code tables, the table
+ * of every character is chosen by the previous decoded character. Every
+ * table is one level lookup table indexed by the bits of its longest
+ * code, so codes are not longer then MAX_TABLE_CODE_LENGTH and small
+ * tables take only a few entries. All tables are stored in one array.
+ */
+class ContextDecodeTable{
+
+public:
+
+    /* Maximal code length supported by the tables*/
+    static const int MAX_TABLE_CODE_LENGTH = DecodeTable::FIRST_LEVEL_BITS;
+
+    /* Constructor: ContextDecodeTable
+     * Usage: ContextDecodeTable table;
+     * -----------------------------------------------------
+     * Initializes a new table without contexts
+     */
+    ContextDecodeTable();
+
+    /* Method: clear
+     * Usage: table.clear();
+     * -----------------------------------------------------
+     * Removes all tables and contexts, memory is kept
+     */
+    void clear();
+
+    /* Method: addTable
+     * Usage: int index = table.addTable(codes);
+     * -----------------------------------------------------
+     * Adds lookup table built from BYTES_NUMBER canonical codes
+     * and returns its index. Throws an exception if some code
+     * is longer then MAX_TABLE_CODE_LENGTH.
+     */
+    int addTable(const HuffmanCode *codes);
+
+    /* Method: setContext
+     * Usage: table.setContext(previous, index);
+     * -----------------------------------------------------
+     * Characters after the "context" character are decoded
+     * by the table with received index.
+     */
+    void setContext(int context, int table);
+
+    /* Method: decode
+     * Usage: table.decode(reader, buffer, count);
+     * -----------------------------------------------------
+     * Decodes "count" characters from the reader to the output
+     * buffer. Context of the first character is character 0.
+     */
+    void decode(BitReader &reader, char *out, size_t count) const;
+
+private:
+
+    /* Entry of the lookup table, length is 0 for bits which are not a code*/
+    struct Entry {
+        uint8_t value;
+        uint8_t length;
+    };
+
+    /* Position of the lookup table and number of bits of its index*/
+    struct Table {
+        uint32_t offset;
+        uint8_t bits;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<Table> tables;
+    Table contexts[BYTES_NUMBER]; // bits is 0 if the context has no table
+};
+
+#endif // CODETABLE_H
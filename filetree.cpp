@@ -0,0 +1,75 @@
+/* File: filetree.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements walking the trees of directories by POSIX functions.
+ */
+
+#include "filetree.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+/** Function: listFiles
+ * Usage: listFiles(path, filenames);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function reads entries of the directory, sorts them, so the same tree gives the same
+ * order of the files, and walks subdirectories recursively. Links are followed, entries which
+ * are neither files nor directories are skipped.
+ *
+ * @param path Name of the file or directory
+ * @param filenames Array for the names of the files, names are appended to its end
+ */
+void listFiles(const string &path, vector<string> &filenames){
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) throw runtime_error("Could not open " + path);
+    if (!S_ISDIR(info.st_mode)){
+        filenames.push_back(path);
+        return;
+    }
+
+    DIR *directory = opendir(path.c_str());
+    if (directory == nullptr) throw runtime_error("Could not open " + path);
+    vector<string> entries;
+    while (dirent *entry = readdir(directory)){
+        string name = entry->d_name;
+        if (name != "." && name != "..") entries.push_back(name);
+    }
+    closedir(directory);
+    sort(entries.begin(), entries.end());
+
+    string prefix = (path[path.length() - 1] == '/') ? path : path + "/";
+    for (size_t i = 0; i < entries.size(); i++){
+        string name = prefix + entries[i];
+        if (stat(name.c_str(), &info) != 0) throw runtime_error("Could not open " + name);
+        if (S_ISDIR(info.st_mode)){
+            listFiles(name, filenames);
+        } else if (S_ISREG(info.st_mode)){
+            filenames.push_back(name);
+        }
+    }
+}
+
+/** Function: createDirectories
+ * Usage: createDirectories(filename);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function creates directories of the path one after another from the first one,
+ * existing directories are kept.
+ *
+ * @param filename Name of the file
+ */
+void createDirectories(const string &filename){
+    for (size_t separator = filename.find('/', 1); separator != string::npos; separator = filename.find('/', separator + 1)){
+        string directory = filename.substr(0, separator);
+        if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST){
+            throw runtime_error("Could not create " + directory);
+        }
+    }
+}
@@ -0,0 +1,30 @@
+/* File: filetree.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports functions for walking the trees of directories,
+ * used by the archiver for packing many files to one container.
+ */
+
+#ifndef FILETREE_H
+#define FILETREE_H
+
+#include <string>
+#include <vector>
+
+/* Function: listFiles
+ * Usage: listFiles(path, filenames);
+ * -----------------------------------------------------
+ * Appends names of all regular files placed in the directory and its
+ * subdirectories to the array, names of every directory go sorted. If the
+ * path is not a directory, only the path itself is appended.
+ */
+void listFiles(const std::string &path, std::vector<std::string> &filenames);
+
+/* Function: createDirectories
+ * Usage: createDirectories(filename);
+ * -----------------------------------------------------
+ * Creates all missing directories of the path to the file.
+ */
+void createDirectories(const std::string &filename);
+
+#endif // FILETREE_H
@@ -0,0 +1,137 @@
+/* File: histogram.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements counting of the byte frequencies. Simple loop "counts[byte]++" is slow on
+ * long runs of the same byte, because every increment has to wait for the store of the previous one.
+ * So bytes are counted in eight separate tables, one for every position of the byte in 64-bit word,
+ * and tables are summed at the end. On processors with AVX2 or AVX-512 the vector comparison finds
+ * runs of the same byte, which are counted by one addition.
+ */
+
+#include <cstring>
+
+#include "histogram.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define HISTOGRAM_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace {
+
+const int TABLES_NUMBER = 8;
+const int VALUES_NUMBER = 256;
+
+/* Counters of the tables are 32-bit, so data is counted by portions not longer then this*/
+const size_t MAX_PORTION = (size_t)1 << 30;
+
+typedef uint32_t Tables[TABLES_NUMBER][VALUES_NUMBER];
+
+/* Counts eight bytes of the word, every byte in its own table*/
+inline void countWord(Tables &tables, uint64_t word){
+    tables[0][word & 0xFF]++;
+    tables[1][(word >> 8) & 0xFF]++;
+    tables[2][(word >> 16) & 0xFF]++;
+    tables[3][(word >> 24) & 0xFF]++;
+    tables[4][(word >> 32) & 0xFF]++;
+    tables[5][(word >> 40) & 0xFF]++;
+    tables[6][(word >> 48) & 0xFF]++;
+    tables[7][word >> 56]++;
+}
+
+/* Counts "length" bytes starting from "data", length should be divisible by 8*/
+inline void countWords(Tables &tables, const unsigned char *data, size_t length){
+    for (size_t i = 0; i < length; i += 8){
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        countWord(tables, word);
+    }
+}
+
+/* Counts bytes after the last whole word and adds all tables to the counters*/
+inline void finishCount(Tables &tables, const unsigned char *data, size_t length, uint64_t *counts){
+    for (size_t i = 0; i < length; i++){
+        tables[0][data[i]]++;
+    }
+    for (int value = 0; value < VALUES_NUMBER; value++){
+        uint64_t sum = 0;
+        for (int table = 0; table < TABLES_NUMBER; table++){
+            sum += tables[table][value];
+        }
+        counts[value] += sum;
+    }
+}
+
+void countScalar(const unsigned char *data, size_t length, uint64_t *counts){
+    Tables tables = {{0}};
+    size_t words = length & ~(size_t)7;
+    countWords(tables, data, words);
+    finishCount(tables, data + words, length - words, counts);
+}
+
+#ifdef HISTOGRAM_X86_DISPATCH
+
+__attribute__((target("avx2")))
+void countAvx2(const unsigned char *data, size_t length, uint64_t *counts){
+    Tables tables = {{0}};
+    size_t pos = 0;
+    for (; pos + 32 <= length; pos += 32){
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)(data + pos));
+        __m256i first = _mm256_set1_epi8((char)data[pos]);
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, first)) == -1){
+            tables[0][data[pos]] += 32;
+        } else {
+            countWords(tables, data + pos, 32);
+        }
+    }
+    size_t words = (length - pos) & ~(size_t)7;
+    countWords(tables, data + pos, words);
+    pos += words;
+    finishCount(tables, data + pos, length - pos, counts);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+void countAvx512(const unsigned char *data, size_t length, uint64_t *counts){
+    Tables tables = {{0}};
+    size_t pos = 0;
+    for (; pos + 64 <= length; pos += 64){
+        __m512i chunk = _mm512_loadu_si512((const void*)(data + pos));
+        __m512i first = _mm512_set1_epi8((char)data[pos]);
+        if (_mm512_cmpeq_epi8_mask(chunk, first) == ~(__mmask64)0){
+            tables[0][data[pos]] += 64;
+        } else {
+            countWords(tables, data + pos, 64);
+        }
+    }
+    size_t words = (length - pos) & ~(size_t)7;
+    countWords(tables, data + pos, words);
+    pos += words;
+    finishCount(tables, data + pos, length - pos, counts);
+}
+
+#endif
+
+typedef void (*CountFunction)(const unsigned char *data, size_t length, uint64_t *counts);
+
+/* Chooses the best implementation for the current processor*/
+CountFunction chooseKernel(){
+#ifdef HISTOGRAM_X86_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) return countAvx512;
+    if (__builtin_cpu_supports("avx2")) return countAvx2;
+#endif
+    return countScalar;
+}
+
+}
+
+void countBytes(const char *data, size_t length, uint64_t *counts){
+    static const CountFunction function = chooseKernel();
+    const unsigned char *bytes = (const unsigned char*)data;
+    while (length > 0){
+        size_t portion = (length < MAX_PORTION) ? length : MAX_PORTION;
+        function(bytes, portion, counts);
+        bytes += portion;
+        length -= portion;
+    }
+}
@@ -0,0 +1,23 @@
+/* File: histogram.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports function for counting frequencies of the bytes,
+ * the first pass over every block before it could be coded.
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+
+/* Function: countBytes
+ * Usage: countBytes(data, length, counts);
+ * --------------------------------------------------------------
+ * Adds number of occurrences of every byte value in the received
+ * array to the array of 256 counters. The best implementation for
+ * the current processor is chosen at the first call.
+ */
+void countBytes(const char *data, size_t length, uint64_t *counts);
+
+#endif // HISTOGRAM_H
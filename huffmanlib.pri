@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Sources of the archiver library, shared by the library,
+# the console program and the benchmark
+#
+#-------------------------------------------------
+
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/archiver.cpp \
+    $$PWD/blockcoder.cpp \
+    $$PWD/checksum.cpp \
+    $$PWD/codetable.cpp \
+    $$PWD/filetree.cpp \
+    $$PWD/histogram.cpp \
+    $$PWD/mappedfile.cpp \
+    $$PWD/sharedtable.cpp \
+    $$PWD/threadpool.cpp
+
+HEADERS += \
+    $$PWD/archiver.h \
+    $$PWD/bitstream.h \
+    $$PWD/blockcoder.h \
+    $$PWD/checksum.h \
+    $$PWD/codetable.h \
+    $$PWD/filetree.h \
+    $$PWD/histogram.h \
+    $$PWD/mappedfile.h \
+    $$PWD/pqueueshpp.h \
+    $$PWD/sharedtable.h \
+    $$PWD/threadpool.h \
+    $$PWD/vectorshpp.h
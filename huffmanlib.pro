@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Static library of the archiver for coding data in memory
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = huffman
+CONFIG += staticlib
+CONFIG += c++11
+CONFIG += thread
+
+DEFINES += _FILE_OFFSET_BITS=64
+
+TEMPLATE = lib
+
+include(huffmanlib.pri)
@@ -0,0 +1,85 @@
+/* File: mappedfile.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements file mapped to the memory by POSIX mmap.
+ */
+
+#include "mappedfile.h"
+
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+MappedFile::MappedFile(){
+    fd = -1;
+    bytes = nullptr;
+    length = 0;
+    writable = false;
+}
+
+MappedFile::~MappedFile(){
+    if (bytes != nullptr) munmap(bytes, length);
+    if (fd >= 0) ::close(fd);
+}
+
+void MappedFile::openForReading(const string &filename, AccessPattern pattern){
+    this->filename = filename;
+    fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) throw runtime_error("Could not open " + filename);
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) throw runtime_error("Could not open " + filename);
+    length = info.st_size;
+    map(PROT_READ);
+    if (bytes != nullptr) madvise(bytes, length, (pattern == RANDOM_ACCESS) ? MADV_RANDOM : MADV_SEQUENTIAL);
+}
+
+void MappedFile::create(const string &filename, uint64_t size){
+    this->filename = filename;
+    fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || ftruncate(fd, size) != 0) throw runtime_error("Could not write " + filename);
+
+    /* Blocks are reserved at once, because writing to the mapping of the full disk
+     * kills the process by SIGBUS instead of the error*/
+    if (size > 0 && posix_fallocate(fd, 0, size) != 0) throw runtime_error("Not enough space to write " + filename);
+    length = size;
+    writable = true;
+    map(PROT_READ | PROT_WRITE);
+}
+
+void MappedFile::map(int protection){
+    if (length == 0) return;
+    if ((uint64_t)(size_t)length != length) throw runtime_error("File is too large " + filename);
+    void *address = mmap(nullptr, length, protection, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) throw runtime_error("Could not map " + filename);
+    bytes = (char*)address;
+}
+
+void MappedFile::close(){
+    bool failed = false;
+    if (bytes != nullptr){
+        failed = writable && msync(bytes, length, MS_SYNC) != 0;
+        failed = (munmap(bytes, length) != 0) || failed;
+        bytes = nullptr;
+    }
+    if (fd >= 0){
+        failed = (::close(fd) != 0) || failed;
+        fd = -1;
+    }
+    length = 0;
+    writable = false;
+    if (failed) throw runtime_error("Could not write " + filename);
+}
+
+char * MappedFile::data() const{
+    return bytes;
+}
+
+uint64_t MappedFile::size() const{
+    return length;
+}
@@ -0,0 +1,105 @@
+/* File: mappedfile.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports file mapped to the memory, used by the archiver
+ * instead of reading and writing files through the stream buffers.
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/* Class: MappedFile
+ * --------------------------------------------------------------
+ *
+ * This class maps the whole file to the memory. File could be opened
+ * for reading or created with the known size for writing. Pages are loaded
+ * and written back by the page cache, so data is never copied to the
+ * separate buffers. Mapping of the empty file has no data at all.
+ */
+class MappedFile{
+
+public:
+
+    /* Expected order of reading the pages of the mapped file*/
+    enum AccessPattern {
+        SEQUENTIAL_ACCESS, // whole file is read from the beginning, pages are read ahead
+        RANDOM_ACCESS // only separate parts of the file are read, no pages are read ahead
+    };
+
+    /* Constructor: MappedFile
+     * Usage: MappedFile file;
+     * -----------------------------------------------------
+     * Initializes a new object without any file.
+     */
+    MappedFile();
+
+    /* Destructor: ~MappedFile
+     * -----------------------------------------------------
+     * Unmaps and closes the file, if it is still opened.
+     */
+    virtual ~MappedFile();
+
+    /* Method: openForReading
+     * Usage: file.openForReading(filename, MappedFile::RANDOM_ACCESS);
+     * -----------------------------------------------------
+     * Maps existing file for reading. The kernel is advised about the
+     * received access pattern, by default pages are expected to be read
+     * sequentially, so they are read ahead.
+     */
+    void openForReading(const std::string &filename, AccessPattern pattern = SEQUENTIAL_ACCESS);
+
+    /* Method: create
+     * Usage: file.create(filename, size);
+     * -----------------------------------------------------
+     * Creates new file of the received size, or truncates existing one,
+     * and maps it for writing. Blocks of the file are reserved on the disk
+     * before mapping, so lack of space is reported by an exception.
+     */
+    void create(const std::string &filename, uint64_t size);
+
+    /* Method: close
+     * Usage: file.close();
+     * -----------------------------------------------------
+     * Unmaps and closes the file. Written data is synchronized with the
+     * disk first, throws an exception if it could not be saved.
+     */
+    void close();
+
+    /* Method: data
+     * Usage: const char *bytes = file.data();
+     * -----------------------------------------------------
+     * Returns pointer to the first byte of the mapped file.
+     */
+    char * data() const;
+
+    /* Method: size
+     * Usage: uint64_t size = file.size();
+     * -----------------------------------------------------
+     * Returns size of the mapped file in bytes.
+     */
+    uint64_t size() const;
+
+private:
+
+    std::string filename;
+    int fd;
+    char *bytes;
+    uint64_t length;
+    bool writable; // file is created for writing and should be synchronized
+
+    /* Method: map
+     * ------------------------------------------------
+     * Maps opened file with received protection.
+     */
+    void map(int protection);
+
+    /* File could not be copied*/
+    MappedFile(const MappedFile &src);
+    MappedFile & operator=(const MappedFile &src);
+};
+
+#endif // MAPPEDFILE_H
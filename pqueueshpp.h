@@ -1,24 +1,33 @@
 /* File: pqueueshpp.h
  * -----------------------------------------------------
  * This file exports a simple version of the Priority Queue class
- * based on the binary heap.
+ * based on the implicit d-ary heap stored in the flat array.
  */
 #ifndef PQUEUESHPP_H
 #define PQUEUESHPP_H
 
-#include <iostream>
-//#include <vector>
-#include <string>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
 #include "vectorshpp.h"
 
-/* Class: PQueueSHPP<ValueType>
+/* Class: PQueueSHPP<ValueType, PriorityType, Compare, ARITY>
  * ---------------------------------------------------
  * This clas implements priority queue of a specified ValueType
- * elements
+ * elements. Elements are kept together with their priorities in one
+ * array, children of the element at index i are placed at indexes
+ * from ARITY * i + 1 to ARITY * i + ARITY. Element with priority "a"
+ * goes before element with priority "b" if Compare()(a, b) is true,
+ * so by default element with the lowest priority is dequeued first.
+ * Order of the elements with equal priorities is not specified.
  */
-template<typename ValueType>
+template<typename ValueType, typename PriorityType = uint64_t,
+         typename Compare = std::less<PriorityType>, int ARITY = 2>
 class PQueueSHPP{
 
+    static_assert(ARITY >= 2, "Heap should have at least two children of every element");
+
     /* Public methods prototypes*/
 public:
     /** Constructor: PQueueSHPP
@@ -26,13 +35,7 @@ public:
      * -----------------------------------------------
      * Initializes a new empty priority queue
      */
-    PQueueSHPP();
-
-    /** Destructor: ~PQueueSHPP
-     * ----------------------------------------------
-     * Frees all allocated memory for the queue elements
-     */
-    virtual ~PQueueSHPP();
+    explicit PQueueSHPP(const Compare &compare = Compare());
 
     /** Method: enqueue
      * Usage: pqueue.enqueue(value, priority);
@@ -40,7 +43,7 @@ public:
      * Adds new element to the queue with specified value
      * and priority.
      */
-    void enqueue(ValueType, double);
+    void enqueue(ValueType value, PriorityType priority);
 
     /** Method; dequeue
      * Usage: value = pqueue.dequeue();
@@ -56,31 +59,37 @@ public:
      * Returns value of the element with hightest priority
      * without removing it
      */
-    ValueType peek();
-
+    ValueType peek() const;
 
     /** Method: peekPriority
-     * Usage: double priority = pqueue.peekProirity();
+     * Usage: PriorityType priority = pqueue.peekProirity();
      * ------------------------------------------------
      * Returns the highest priority currently present in
      * the queue
      */
-    double peekPriority();
+    PriorityType peekPriority() const;
 
     /** Method: clear
      * Usage: pqueue.clear();
      * -----------------------------------------------
-     * Removes all elements in the queue
-     *
+     * Removes all elements in the queue, memory of the
+     * array is kept for the next elements
      */
     void clear();
 
+    /** Method: reserve
+     * Usage: pqueue.reserve(count);
+     * -----------------------------------------------
+     * Allocates memory for "count" elements at once
+     */
+    void reserve(int count);
+
     /** Method: isEmpty
      * Usage: if (pqueue.isEmpty())...
      * ----------------------------------------------
      * Returns true if queue is empty
      */
-    bool isEmpty();
+    bool isEmpty() const;
 
     /** Method: size
      * Usage: int size = pqueue.size();
@@ -88,273 +97,129 @@ public:
      * Returns current number of the elements
      * in the queue
      */
-    int size();
-
-
-    /**
-     * Copy constructor
-     * ---------------------------------------------
-     * @param src Source instance of PQueue
-     */
-    PQueueSHPP(const PQueueSHPP<ValueType>& src);
-
-    PQueueSHPP<ValueType> & operator=(const PQueueSHPP<ValueType>& src);
-
-
+    int size() const;
 
 private:
 
     /* Structure for saving elements of the queue*/
-    struct Node{
+    struct Entry{
+        PriorityType priority;
         ValueType value;
-        double priority;
-        Node* left;
-        Node* right;
-        Node* parent;
-
     };
 
-    /*Vector for array-based representaton og the heap*/
-    VectorSHPP<Node*> vec;
-    int counter;
+    /* Array-based representaton of the heap*/
+    VectorSHPP<Entry> heap;
+    Compare compare;
 
     /**
      * Method: shiftUp
      * ------------------------------------------------
-     * This method used for shifting up Node in the heap
-     * to the right position of the priority
-     * @param node Pointer to the moved node
+     * This method moves element up from the received
+     * position to the right position of the priority
+     * @param index Position of the moved element
      */
-    void shiftUp(Node* node);
+    void shiftUp(int index);
 
     /**
      * Method: shiftDown
      * ------------------------------------------------
-     * This method used for shifting down Node in the heap
-     * to the right position of the priority
-     * @param node Pointer to the moved node
+     * This method moves element down from the received
+     * position to the right position of the priority
+     * @param index Position of the moved element
      */
-    void shiftDown(Node* node);
-
-    /**
-     * Method: replace
-     * ----------------------------------------------
-     * This method replace the value and priority
-     * of two received nodes
-     * @param node1
-     * @param node2
-     */
-    void replace(Node* node1, Node* node2);
-
-    /**
-     * Method: deleteHeap
-     * ---------------------------------------------
-     * This method recursively removes all nodes of the heap
-     * @param node Root node of the heap
-     */
-    void deleteHeap(Node* node);
-
-    /**
-     * Method: deepCopy
-     * ----------------------------------------------
-     * This method provides deep coping for copy constructor
-     * and operator = ;
-     * @param src
-     */
-    void deepCopy(const PQueueSHPP<ValueType> & src);
-
+    void shiftDown(int index);
 };
 
-template<typename ValueType>
-PQueueSHPP<ValueType>::PQueueSHPP(){
-    counter = 0;
-}
-
-
-template<typename ValueType>
-PQueueSHPP<ValueType>::~PQueueSHPP(){}
-
-
-template<typename ValueType>
-void PQueueSHPP<ValueType>::replace(Node *node1, Node *node2){
-    double tmpPriority = node1->priority;
-    ValueType tmpValue = node1->value;
-    node1->priority = node2->priority;
-    node1->value = node2->value;
-    node2->priority = tmpPriority;
-    node2->value = tmpValue;
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::PQueueSHPP(const Compare &compare) : compare(compare){
 }
 
-template<typename ValueType>
-void PQueueSHPP<ValueType>::shiftUp(Node *node){
-    if (node->parent != 0 && node->parent->priority >= node->priority){
-        replace(node, node->parent);
-        shiftUp(node->parent);
-    }
-}
-
-template<typename ValueType>
-void PQueueSHPP<ValueType>::shiftDown(Node *node){
-    if (node->left != 0 && node->right != 0){
-        if (node->left->priority < node->right->priority && node->left->priority < node->priority){
-            replace(node->left, node);
-            shiftDown(node->left);
-        } else if (node->left->priority >= node->right->priority && node->right->priority < node->priority) {
-            replace(node->right, node);
-            shiftDown(node->right);
-        }
-    } else if (node->left == 0 && node->right != 0 && node->right->priority < node->priority){
-        replace(node->right, node);
-        shiftDown(node->right);
-    } else if (node->right == 0 && node->left != 0 && node->left->priority < node->priority){
-        replace(node->left, node);
-        shiftDown(node->left);
-    }
-}
-
-template<typename ValueType>
-void PQueueSHPP<ValueType>::deleteHeap(Node *node){
-    if (node->left != 0){
-        deleteHeap(node->left);
-    }
-    if (node->right != 0){
-        deleteHeap(node->right);
+/* Element is moved up while its parent does not go strictly before it, so
+ * the new element goes above the elements with the same priority.
+ */
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+void PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::shiftUp(int index){
+    Entry entry = std::move(heap[index]);
+    while (index > 0){
+        int parent = (index - 1) / ARITY;
+        if (compare(heap[parent].priority, entry.priority)) break;
+        heap[index] = std::move(heap[parent]);
+        index = parent;
     }
-    delete node;
-    counter = 0;
+    heap[index] = std::move(entry);
 }
 
-template<typename ValueType>
-void PQueueSHPP<ValueType>::deepCopy(const PQueueSHPP<ValueType> & src){
-    for (unsigned int i = 0; i < src.vec.size(); i++){
-        Node* newNode = new Node;
-        newNode->priority = src.vec[i]->priority;
-        newNode->value = src.vec[i]->value;
-        this->counter = src.counter;
-        this->vec.add(newNode);
-    }
-
-    for(unsigned int i = 0; i < vec.size(); i++){
-
-        if (2 * i + 1 < vec.size()){
-            vec[i]->left = vec[2 * i + 1];
-        } else {
-            vec[i]->left = 0;
-        }
-
-        if (2 * i + 2 < vec.size()){
-            vec[i]->right = vec[2 * i +2];
-        } else {
-            vec[i]->right = 0;
-        }
-
-        if( i > 0){
-           vec[i]->parent = vec[(i - 1) / 2];
-        } else {
-            vec[i]->parent = 0;
+/* Element is moved down in place of the child which goes first, if several
+ * children have the same priority the last of them is taken.
+ */
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+void PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::shiftDown(int index){
+    int count = heap.size();
+    Entry entry = std::move(heap[index]);
+    while (true){
+        int first = ARITY * index + 1;
+        if (first >= count) break;
+        int last = (count - first < ARITY) ? count : first + ARITY;
+        int best = first;
+        for (int child = first + 1; child < last; child++){
+            if (!compare(heap[best].priority, heap[child].priority)) best = child;
         }
+        if (!compare(heap[best].priority, entry.priority)) break;
+        heap[index] = std::move(heap[best]);
+        index = best;
     }
+    heap[index] = std::move(entry);
 }
 
-
-//------------------------------------------------------------------------------
-
-template<typename ValueType>
-PQueueSHPP<ValueType>::PQueueSHPP(const PQueueSHPP<ValueType>& src){
-    deepCopy(src);
-}
-
-template<typename ValueType>
-PQueueSHPP<ValueType> & PQueueSHPP<ValueType>::operator =(const PQueueSHPP<ValueType>& src){
-    deepCopy(src);
-    return *this;
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+void PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::enqueue(ValueType value, PriorityType priority){
+    heap.add(Entry{priority, std::move(value)});
+    shiftUp(heap.size() - 1);
 }
 
-
-template<typename ValueType>
-void PQueueSHPP<ValueType>::enqueue(ValueType value, double priority){
-    Node* newNode = new Node;
-    newNode->left = newNode->right = newNode->parent = 0;
-    newNode->value = value;
-    newNode->priority = priority;
-    vec.add(newNode);
-    counter++;
-    if(vec.size() > 1){
-        newNode->parent = vec[(vec.size() - 2) / 2];
-        if (vec.size() % 2 == 0){
-            newNode->parent->left = newNode;
-        } else {
-            newNode->parent->right = newNode;
-        }
-        shiftUp(newNode);
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+ValueType PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::dequeue(){
+    if (heap.isEmpty()) return ValueType();
+    ValueType result = std::move(heap[0].value);
+    int last = heap.size() - 1;
+    if (last > 0){
+        heap[0] = std::move(heap[last]);
+        heap.remove(last);
+        shiftDown(0);
+    } else {
+        heap.remove(last);
     }
-
+    return result;
 }
 
-template<typename ValueType>
-ValueType PQueueSHPP<ValueType>::dequeue(){
-
-    if (!isEmpty()){
-        ValueType result;
-        if (vec.size() > 1){
-            Node* startNode = vec[0];
-            Node* endNode = vec[vec.size() - 1];
-            result = startNode->value;
-            startNode->priority = endNode->priority;
-            startNode->value = endNode->value;
-            if (vec.size() % 2 == 0){
-                endNode->parent->left = 0;
-            } else {
-                endNode->parent->right = 0;
-            }
-            vec.remove(vec.size() - 1);
-            //vec.pop_back();
-            delete endNode;
-            shiftDown(startNode);
-        } else if (vec.size() == 1){
-            result = vec[0]->value;
-            delete vec[0];
-            vec.remove(0);
-
-        }
-        counter--;
-        return result;
-    }
-   return 0;
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+ValueType PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::peek() const{
+    return heap[0].value;
 }
 
-template<typename ValueType>
-ValueType PQueueSHPP<ValueType>::peek(){
-    return vec[0]->value;
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+PriorityType PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::peekPriority() const{
+    return heap[0].priority;
 }
 
-
-template<typename ValueType>
-double PQueueSHPP<ValueType>::peekPriority() {
-    return vec[0]->priority;
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+void PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::clear(){
+    heap.clear();
 }
 
-template<typename ValueType>
-void PQueueSHPP<ValueType>::clear(){
-    deleteHeap(vec[0]);
-    vec.clear();
-    counter = 0;
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+void PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::reserve(int count){
+    heap.reserve(count);
 }
 
-template<typename ValueType>
-bool PQueueSHPP<ValueType>::isEmpty() {
-
-    return (vec.size() == 0);
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+bool PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::isEmpty() const{
+    return heap.isEmpty();
 }
 
-template<typename ValueType>
-int PQueueSHPP<ValueType>::size() {
-
-    return vec.size();
+template<typename ValueType, typename PriorityType, typename Compare, int ARITY>
+int PQueueSHPP<ValueType, PriorityType, Compare, ARITY>::size() const{
+    return heap.size();
 }
 
-
-
-
 #endif // PQUEUESHPP
-
@@ -0,0 +1,121 @@
+/* File: sharedtable.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements training, saving and loading of the shared code tables. File of the
+ * table starts with signature and version of the format, then goes number of the table and
+ * code lengths of all characters in the same format as in the blocks of the archive.
+ */
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include "blockcoder.h"
+#include "sharedtable.h"
+
+using namespace std;
+
+/* Function prototypes*/
+shared_ptr<const SharedTable> loadSharedTable(const string &filename, uint64_t id);
+
+const char TABLE_SIGNATURE[] = "HUFT"; // first bytes of every file of the shared table
+const int TABLE_FORMAT_VERSION = 1; // version of the format of the table file
+
+/** Function: trainSharedTable
+ * Usage: trainSharedTable(data, length, options.maxCodeLength, codes);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function counts characters of the sample and adds one to every frequency, so the
+ * characters which are not in the sample get the longest codes. Then canonical codes are
+ * built as for usual block.
+ *
+ * @param data Sample data
+ * @param length Number of the characters of the sample
+ * @param maxCodeLength Limit of the code length
+ * @param codes Array for the codes of the characters
+ */
+void trainSharedTable(const char *data, size_t length, int maxCodeLength, HuffmanCode *codes){
+    uint64_t alphabet[BYTES_NUMBER];
+    getAlphabet(data, length, alphabet);
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        alphabet[i]++;
+    }
+    buildCodes(alphabet, maxCodeLength, codes);
+}
+
+/** Function: saveSharedTable
+ * Usage: saveSharedTable(filename, id, codes);
+ * ------------------------------------------------------------------------------------
+ *
+ * @param filename Name of the file of the table
+ * @param id Number of the table
+ * @param codes Codes of the characters
+ */
+void saveSharedTable(const string &filename, uint64_t id, const HuffmanCode *codes){
+    ofstream file(filename, ofstream::binary);
+    file << TABLE_SIGNATURE << (char)TABLE_FORMAT_VERSION;
+    for (int i = 0; i < 8; i++){
+        file.put((char)(id >> (8 * i)));
+    }
+    file << getCodeLengthsForFile(codes);
+    file.close();
+    if (!file) throw runtime_error("Could not write " + filename);
+}
+
+/** Function: loadSharedTable
+ * Usage: shared_ptr<const SharedTable> table = loadSharedTable(filename, id);
+ * ------------------------------------------------------------------------------------
+ *
+ * This function reads the table from the file, checks that it has expected number and codes
+ * all characters, and builds lookup tables for decoding.
+ *
+ * @param filename Name of the file of the table
+ * @param id Expected number of the table
+ * @return Table ready for coding and decoding
+ */
+shared_ptr<const SharedTable> loadSharedTable(const string &filename, uint64_t id){
+    ifstream file(filename, ifstream::binary);
+    if (!file) throw runtime_error("Shared table is not found " + filename);
+    vector<char> data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+
+    const size_t headerSize = sizeof(TABLE_SIGNATURE) + 8;
+    if (data.size() < headerSize || string(data.data(), sizeof(TABLE_SIGNATURE) - 1) != TABLE_SIGNATURE){
+        throw runtime_error("File is not shared table " + filename);
+    }
+    if (data[sizeof(TABLE_SIGNATURE) - 1] != TABLE_FORMAT_VERSION){
+        throw runtime_error("Unsupported version of the shared table " + filename);
+    }
+    uint64_t fileId = 0;
+    for (int i = 0; i < 8; i++){
+        fileId |= (uint64_t)(unsigned char)data[sizeof(TABLE_SIGNATURE) + i] << (8 * i);
+    }
+    if (fileId != id) throw runtime_error("Wrong number of the shared table " + filename);
+
+    shared_ptr<SharedTable> table(new SharedTable);
+    table->id = id;
+    const char *next = data.data() + headerSize;
+    readCodeLengths(next, data.data() + data.size(), table->codes);
+    for (int i = 0; i < BYTES_NUMBER; i++){
+        if (table->codes[i].length == 0) throw runtime_error("Shared table does not code all characters " + filename);
+    }
+    table->decodeTable.build(table->codes);
+    return table;
+}
+
+SharedTableCache::SharedTableCache(const string &directory){
+    this->directory = directory;
+}
+
+shared_ptr<const SharedTable> SharedTableCache::get(uint64_t id){
+    lock_guard<std::mutex> lock(mutex);
+    map<uint64_t, shared_ptr<const SharedTable> >::iterator found = tables.find(id);
+    if (found != tables.end()) return found->second;
+    shared_ptr<const SharedTable> table = loadSharedTable(getFilename(id), id);
+    tables[id] = table;
+    return table;
+}
+
+string SharedTableCache::getFilename(uint64_t id) const{
+    return directory + "/" + to_string(id) + SHARED_TABLE_EXTENSION;
+}
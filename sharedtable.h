@@ -0,0 +1,91 @@
+/* File: sharedtable.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports code tables trained once from the sample data and
+ * shared by a lot of archives. Archive coded with the shared table stores
+ * only its number, what saves the space of the code lengths in small archives.
+ */
+
+#ifndef SHAREDTABLE_H
+#define SHAREDTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "codetable.h"
+
+/* Extension of the file with the shared table, file name is the number of the table*/
+const char SHARED_TABLE_EXTENSION[] = ".huft";
+
+/* Structure to save the shared table ready for coding and decoding*/
+struct SharedTable {
+    uint64_t id = 0;
+    HuffmanCode codes[BYTES_NUMBER];
+    DecodeTable decodeTable;
+};
+
+/* Function: trainSharedTable
+ * Usage: trainSharedTable(data, length, maxCodeLength, codes);
+ * --------------------------------------------------------------
+ * Builds canonical codes of all BYTES_NUMBER characters from their
+ * frequencies in the sample data. Characters which are not in the
+ * sample also get codes, so any data could be coded by the table.
+ */
+void trainSharedTable(const char *data, size_t length, int maxCodeLength, HuffmanCode *codes);
+
+/* Function: saveSharedTable
+ * Usage: saveSharedTable(filename, id, codes);
+ * --------------------------------------------------------------
+ * Writes number and code lengths of the table to the file.
+ */
+void saveSharedTable(const std::string &filename, uint64_t id, const HuffmanCode *codes);
+
+/* Class: SharedTableCache
+ * --------------------------------------------------------------
+ *
+ * This class loads shared tables from the directory by their numbers.
+ * Every table is read and compiled only once, next requests get the
+ * same object. Tables could be requested by several threads at once.
+ */
+class SharedTableCache{
+
+public:
+
+    /* Constructor: SharedTableCache
+     * Usage: SharedTableCache tables(directory);
+     * -----------------------------------------------------
+     * Initializes a new cache of the tables from the received directory.
+     */
+    explicit SharedTableCache(const std::string &directory);
+
+    /* Method: get
+     * Usage: std::shared_ptr<const SharedTable> table = tables.get(id);
+     * -----------------------------------------------------
+     * Returns table with received number, loads it at the first request.
+     * Throws an exception if the table is not found or is corrupted.
+     */
+    std::shared_ptr<const SharedTable> get(uint64_t id);
+
+    /* Method: getFilename
+     * Usage: string filename = tables.getFilename(id);
+     * -----------------------------------------------------
+     * Returns name of the file of the table with received number.
+     */
+    std::string getFilename(uint64_t id) const;
+
+private:
+
+    std::string directory;
+    std::map<uint64_t, std::shared_ptr<const SharedTable> > tables;
+    std::mutex mutex;
+
+    /* Cache could not be copied*/
+    SharedTableCache(const SharedTableCache &src);
+    SharedTableCache & operator=(const SharedTableCache &src);
+};
+
+#endif // SHAREDTABLE_H
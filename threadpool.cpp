@@ -0,0 +1,93 @@
+/* File: threadpool.cpp
+ * -----------------------------------------------------------------------------------------
+ *
+ * This file implements pool of the worker threads.
+ */
+
+#include "threadpool.h"
+
+using namespace std;
+
+ThreadPool::ThreadPool(int threadsNumber){
+    this->threadsNumber = (threadsNumber > 1) ? threadsNumber : 1;
+    unfinishedTasks = 0;
+    stopping = false;
+    if (this->threadsNumber > 1){
+        for (int i = 0; i < this->threadsNumber; i++){
+            workers.push_back(thread(&ThreadPool::workerLoop, this));
+        }
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        unique_lock<std::mutex> lock(mutex);
+        tasksDone.wait(lock, [this]{ return unfinishedTasks == 0; });
+        stopping = true;
+    }
+    taskAdded.notify_all();
+    for (size_t i = 0; i < workers.size(); i++){
+        workers[i].join();
+    }
+}
+
+void ThreadPool::submit(const function<void()> &task){
+    if (workers.empty()){
+        try{
+            task();
+        }
+        catch(...){
+            if (!error) error = current_exception();
+        }
+        return;
+    }
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        tasks.push(task);
+        unfinishedTasks++;
+    }
+    taskAdded.notify_one();
+}
+
+void ThreadPool::wait(){
+    unique_lock<std::mutex> lock(mutex);
+    tasksDone.wait(lock, [this]{ return unfinishedTasks == 0; });
+    if (error){
+        exception_ptr result = error;
+        error = nullptr;
+        rethrow_exception(result);
+    }
+}
+
+int ThreadPool::size() const{
+    return threadsNumber;
+}
+
+void ThreadPool::workerLoop(){
+    while (true){
+        function<void()> task;
+        {
+            unique_lock<std::mutex> lock(mutex);
+            taskAdded.wait(lock, [this]{ return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = tasks.front();
+            tasks.pop();
+        }
+
+        exception_ptr taskError;
+        try{
+            task();
+        }
+        catch(...){
+            taskError = current_exception();
+        }
+
+        {
+            lock_guard<std::mutex> lock(mutex);
+            if (taskError && !error) error = taskError;
+            unfinishedTasks--;
+            if (unfinishedTasks == 0) tasksDone.notify_all();
+        }
+    }
+}
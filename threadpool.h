@@ -0,0 +1,90 @@
+/* File: threadpool.h
+ * ----------------------------------------------------------------
+ *
+ * This file exports simple pool of the worker threads used for
+ * processing blocks of the file in parallel.
+ */
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/* Class: ThreadPool
+ * --------------------------------------------------------------
+ *
+ * This class runs submitted tasks on the fixed number of threads.
+ * Pool of one thread has no workers at all, its tasks are run
+ * immediately in the calling thread.
+ */
+class ThreadPool{
+
+public:
+
+    /* Constructor: ThreadPool
+     * Usage: ThreadPool pool(threadsNumber);
+     * -----------------------------------------------------
+     * Starts received number of the worker threads.
+     */
+    explicit ThreadPool(int threadsNumber);
+
+    /* Destructor: ~ThreadPool
+     * -----------------------------------------------------
+     * Waits for all submitted tasks and stops the workers.
+     */
+    virtual ~ThreadPool();
+
+    /* Method: submit
+     * Usage: pool.submit(task);
+     * -----------------------------------------------------
+     * Adds new task to the queue of the pool.
+     */
+    void submit(const std::function<void()> &task);
+
+    /* Method: wait
+     * Usage: pool.wait();
+     * -----------------------------------------------------
+     * Waits until all submitted tasks are done. If some task has
+     * thrown an exception, it is rethrown here.
+     */
+    void wait();
+
+    /* Method: size
+     * Usage: int threads = pool.size();
+     * -----------------------------------------------------
+     * Returns number of the threads used by the pool.
+     */
+    int size() const;
+
+private:
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()> > tasks;
+    std::mutex mutex;
+    std::condition_variable taskAdded;
+    std::condition_variable tasksDone;
+
+    int threadsNumber;
+    int unfinishedTasks; // tasks in the queue and running now
+    bool stopping;
+    std::exception_ptr error; // first exception thrown by the tasks
+
+    /* Method: workerLoop
+     * ------------------------------------------------
+     * Body of the worker thread: takes tasks from the
+     * queue and runs them until pool is stopped.
+     */
+    void workerLoop();
+
+    /* Pool could not be copied*/
+    ThreadPool(const ThreadPool &src);
+    ThreadPool & operator=(const ThreadPool &src);
+};
+
+#endif // THREADPOOL_H
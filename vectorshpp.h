@@ -8,15 +8,20 @@
 #ifndef VECTORSHPP_H
 #define VECTORSHPP_H
 
+#include <cstdlib>
 #include <iostream>
+#include <memory>
+#include <utility>
 
 /* Class: VectorSHPP
  * --------------------------------------------------------------
  *
  * This class stores an ordered list of values similar to array.
- * But it also support inserting and deletig elements.
+ * But it also support inserting and deletig elements. Memory is
+ * taken from the allocator, elements are constructed only in the
+ * used part of it, so unused capacity costs no constructors.
  */
-template<typename ValueType>
+template<typename ValueType, typename Allocator = std::allocator<ValueType> >
 class VectorSHPP{
 
 /* Public methods prototypes*/
@@ -24,10 +29,12 @@ public:
 
     /* Constructor: VectorSHPP
      * Usage: VectorSHPP<ValueType> vector;
+     *        VectorSHPP<ValueType, ArenaAllocator> vector(allocator);
      * -----------------------------------------------------
-     * Initializes a new empty Vector
+     * Initializes a new empty Vector, no memory is allocated
+     * until the first element is added
      */
-    VectorSHPP();
+    explicit VectorSHPP(const Allocator &allocator = Allocator());
 
     /* Destructor: ~VectorSHPP
      * -----------------------------------------------------
@@ -38,14 +45,25 @@ public:
     /* Method: add
      * Usage: vector.add(value);
      * -----------------------------------------------------
-     * Adds a new value to the end of the list
+     * Adds a new value to the end of the list, temporary
+     * values are moved instead of copying
      */
-    void add(ValueType);
+    void add(const ValueType &value);
+    void add(ValueType &&value);
+
+    /* Method: emplace
+     * Usage: vector.emplace(arguments...);
+     * -----------------------------------------------------
+     * Constructs a new value at the end of the list from
+     * received arguments of its constructor
+     */
+    template<typename... Arguments>
+    void emplace(Arguments&&... arguments);
 
     /* Method: clear
      * Usage: vector.clear();
      * -----------------------------------------------------
-     * Removes all elements in the Vector
+     * Removes all elements in the Vector, memory is kept
      */
     void clear();
 
@@ -94,6 +112,30 @@ public:
      */
     int size() const;
 
+    /* Method: capacity
+     * Usage: int capacity = vector.capacity();
+     * ----------------------------------------------------
+     * Returns number of the elements, which could be stored
+     * without new allocation.
+     */
+    int capacity() const;
+
+    /* Method: reserve
+     * Usage: vector.reserve(count);
+     * ----------------------------------------------------
+     * Allocates memory for "count" elements at once, if
+     * current capacity is less.
+     */
+    void reserve(int count);
+
+    /* Method: shrink_to_fit
+     * Usage: vector.shrink_to_fit();
+     * ----------------------------------------------------
+     * Frees unused capacity, so exactly the current number
+     * of the elements is kept.
+     */
+    void shrink_to_fit();
+
     /* Operator: []
      * Usage: vector[index];
      * -----------------------------------------------------
@@ -101,20 +143,30 @@ public:
      * standart arrays.
      */
     const ValueType& operator[](int) const;
+    ValueType& operator[](int);
 
     /* Copy constructor*/
-    VectorSHPP(const VectorSHPP<ValueType> & src);
+    VectorSHPP(const VectorSHPP<ValueType, Allocator> & src);
+
+    /* Move constructor, memory of the source is taken, source becomes empty*/
+    VectorSHPP(VectorSHPP<ValueType, Allocator> && src);
 
     /* Operator: =
      * vectorNew = vectorOld;
      * -----------------------------------------------------
      * Overloads assign operator
      */
-    VectorSHPP<ValueType> & operator=(const VectorSHPP<ValueType> & src);
+    VectorSHPP<ValueType, Allocator> & operator=(const VectorSHPP<ValueType, Allocator> & src);
+    VectorSHPP<ValueType, Allocator> & operator=(VectorSHPP<ValueType, Allocator> && src);
 
 /* Private methods prototypes and instase variables*/
 private:
 
+    typedef std::allocator_traits<Allocator> AllocatorTraits;
+
+    /* Allocator of the dynamic array*/
+    Allocator allocator;
+
     /* Dynamic array for storing elements*/
     ValueType *array;
 
@@ -134,151 +186,261 @@ private:
      */
     void extendArray();
 
+    /* Method: reallocate
+     * Usage: reallocate(newSize);
+     * ------------------------------------------------
+     * Moves elements to the new array of received size
+     * and frees the old one
+     */
+    void reallocate(int newSize);
+
+    /* Method: release
+     * Usage: release();
+     * ------------------------------------------------
+     * Destroys all elements and frees the array
+     */
+    void release();
+
+    /* Method: checkIndex
+     * Usage: checkIndex(index, "get");
+     * ------------------------------------------------
+     * Stops the program if index is out of elements
+     */
+    void checkIndex(int index, const char *method) const;
+
     /* Method: deepCoping;
      * Usage: deepCoping(VectorSHPP src);
      * ------------------------------------------------
      * Coping received  VectorSHPP to "this" VectorSHPP
      */
-    void deepCoping(const VectorSHPP<ValueType> & src);
+    void deepCoping(const VectorSHPP<ValueType, Allocator> & src);
 
 };
 
 
-template<typename ValueType>
-VectorSHPP<ValueType>::VectorSHPP(){
-    array = new ValueType[START_SIZE];
-    currentSize = START_SIZE;
+template<typename ValueType, typename Allocator>
+VectorSHPP<ValueType, Allocator>::VectorSHPP(const Allocator &allocator) : allocator(allocator){
+    array = nullptr;
+    currentSize = 0;
     count = 0;
 }
 
-
-template<typename ValueType>
-void VectorSHPP<ValueType>::deepCoping(const VectorSHPP<ValueType> &src){
-    this->array = new ValueType[src.currentSize];
-    count = src.count;
-    currentSize = src.currentSize;
+template<typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::deepCoping(const VectorSHPP<ValueType, Allocator> &src){
+    array = nullptr;
+    currentSize = count = 0;
+    if (src.count == 0) return;
+    array = AllocatorTraits::allocate(allocator, src.count);
+    currentSize = src.count;
     for (int i = 0; i < src.count; i++){
-        array[i] = src.array[i];
+        AllocatorTraits::construct(allocator, array + i, src.array[i]);
+        count++;
     }
 }
 
-template<typename ValueType>
-VectorSHPP<ValueType>::VectorSHPP(const VectorSHPP<ValueType> & src){
+template<typename ValueType, typename Allocator>
+VectorSHPP<ValueType, Allocator>::VectorSHPP(const VectorSHPP<ValueType, Allocator> & src)
+    : allocator(AllocatorTraits::select_on_container_copy_construction(src.allocator)){
     deepCoping(src);
 }
 
-template<typename ValueType>
-VectorSHPP<ValueType> & VectorSHPP<ValueType>::operator =(const VectorSHPP<ValueType> & src){
-    delete[] array;
-    deepCoping(src);
+template<typename ValueType, typename Allocator>
+VectorSHPP<ValueType, Allocator>::VectorSHPP(VectorSHPP<ValueType, Allocator> && src)
+    : allocator(std::move(src.allocator)){
+    array = src.array;
+    currentSize = src.currentSize;
+    count = src.count;
+    src.array = nullptr;
+    src.currentSize = src.count = 0;
+}
+
+template<typename ValueType, typename Allocator>
+VectorSHPP<ValueType, Allocator> & VectorSHPP<ValueType, Allocator>::operator =(const VectorSHPP<ValueType, Allocator> & src){
+    if (this != &src){
+        release();
+        deepCoping(src);
+    }
     return *this;
 }
 
-template<typename ValueType>
-const ValueType & VectorSHPP<ValueType>::operator[](int index) const {
+/* Memory of the source could be taken only if it is freed by the same allocator,
+ * otherwise elements are moved one by one to the own memory.
+ */
+template<typename ValueType, typename Allocator>
+VectorSHPP<ValueType, Allocator> & VectorSHPP<ValueType, Allocator>::operator =(VectorSHPP<ValueType, Allocator> && src){
+    if (this == &src) return *this;
+    release();
+    if (AllocatorTraits::propagate_on_container_move_assignment::value || allocator == src.allocator){
+        if (AllocatorTraits::propagate_on_container_move_assignment::value) allocator = std::move(src.allocator);
+        array = src.array;
+        currentSize = src.currentSize;
+        count = src.count;
+        src.array = nullptr;
+        src.currentSize = src.count = 0;
+    } else {
+        reserve(src.count);
+        for (int i = 0; i < src.count; i++){
+            add(std::move(src.array[i]));
+        }
+        src.release();
+    }
+    return *this;
+}
+
+template<typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::checkIndex(int index, const char *method) const{
     if(index < 0 || index >= count){
-        std::cout << "operator[]::Fatal error: index is not valid" << std::endl;
+        std::cout << method << "::Fatal error: index is not valid" << std::endl;
         exit(1);
     }
+}
 
+template<typename ValueType, typename Allocator>
+const ValueType & VectorSHPP<ValueType, Allocator>::operator[](int index) const {
+    checkIndex(index, "operator[]");
     return array[index];
 }
 
-template<typename ValueType>
-void VectorSHPP<ValueType>::add(ValueType value){
-    if (count == currentSize) extendArray();
+template<typename ValueType, typename Allocator>
+ValueType & VectorSHPP<ValueType, Allocator>::operator[](int index) {
+    checkIndex(index, "operator[]");
+    return array[index];
+}
 
-    array[count] = value;
-    count++;
+template<typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::add(const ValueType &value){
+    emplace(value);
 }
 
-template <typename ValueType>
-void VectorSHPP<ValueType>::clear(){
-    count = 0;
+template<typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::add(ValueType &&value){
+    emplace(std::move(value));
 }
 
-template <typename ValueType>
-ValueType VectorSHPP<ValueType>::get(int index) const{
-    if(index < 0 || index >= count){
-        std::cout << "get::Fatal error: index is not valid" << std::endl;
-        exit(1);
+/* Value is constructed before extending of the array, because
+ * arguments could be references to the elements of this vector.
+ */
+template<typename ValueType, typename Allocator>
+template<typename... Arguments>
+void VectorSHPP<ValueType, Allocator>::emplace(Arguments&&... arguments){
+    if (count == currentSize){
+        ValueType value(std::forward<Arguments>(arguments)...);
+        extendArray();
+        AllocatorTraits::construct(allocator, array + count, std::move(value));
+    } else {
+        AllocatorTraits::construct(allocator, array + count, std::forward<Arguments>(arguments)...);
     }
+    count++;
+}
 
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::clear(){
+    for (int i = 0; i < count; i++){
+        AllocatorTraits::destroy(allocator, array + i);
+    }
+    count = 0;
+}
+
+template <typename ValueType, typename Allocator>
+ValueType VectorSHPP<ValueType, Allocator>::get(int index) const{
+    checkIndex(index, "get");
     return array[index];
 }
 
-template <typename ValueType>
-void VectorSHPP<ValueType>::insert(int index, ValueType value){
-    if (count == currentSize) extendArray();
-    if(index < 0 || index >= count){
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::insert(int index, ValueType value){
+    if(index < 0 || index > count){
         std::cout << "insert::Fatal error: index is not valid" << std::endl;
         exit(1);
     }
-
-    ValueType *tmpArray = new ValueType[count - index];
-    int j = 0;
-    for(int i = index; i < count; i++){
-        tmpArray[j] = array[i];
-        j++;
+    if (index == count){
+        add(std::move(value));
+        return;
     }
-    j = 0;
-    array[index] = value;
-    for (int i = index + 1; i <= count; i++){
-        array[i] = tmpArray[j];
-        j++;
+    if (count == currentSize) extendArray();
+
+    AllocatorTraits::construct(allocator, array + count, std::move(array[count - 1]));
+    for (int i = count - 1; i > index; i--){
+        array[i] = std::move(array[i - 1]);
     }
+    array[index] = std::move(value);
     count++;
-
 }
 
-template <typename ValueType>
-bool VectorSHPP<ValueType>::isEmpty() const{
+template <typename ValueType, typename Allocator>
+bool VectorSHPP<ValueType, Allocator>::isEmpty() const{
     return count == 0;
 }
 
-template <typename ValueType>
-void VectorSHPP<ValueType>::remove(int index){
-    if(index < 0 || index >= count){
-        std::cout << "remove::Fatal error: index is not valid" << std::endl;
-        exit(1);
-    }
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::remove(int index){
+    checkIndex(index, "remove");
     for(int i = index; i < count-1; i++){
-        array[i] = array[i+1];
+        array[i] = std::move(array[i+1]);
     }
     count--;
+    AllocatorTraits::destroy(allocator, array + count);
 }
 
 
-template <typename ValueType>
-void VectorSHPP<ValueType>::set(int index, ValueType value){
-    if(index < 0 || index >= count){
-        std::cout << "set::Fatal error: index is not valid" << std::endl;
-        exit(1);
-    }
-    array[index] = value;
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::set(int index, ValueType value){
+    checkIndex(index, "set");
+    array[index] = std::move(value);
 }
 
-template <typename ValueType>
-int VectorSHPP<ValueType>::size() const {
+template <typename ValueType, typename Allocator>
+int VectorSHPP<ValueType, Allocator>::size() const {
     return count;
 }
 
-template <typename ValueType>
-void VectorSHPP<ValueType>::extendArray(){
-    ValueType *oldArray = array;
-    currentSize *= 2;
-    array = new ValueType[currentSize];
+template <typename ValueType, typename Allocator>
+int VectorSHPP<ValueType, Allocator>::capacity() const {
+    return currentSize;
+}
 
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::reserve(int newSize){
+    if (newSize > currentSize) reallocate(newSize);
+}
+
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::shrink_to_fit(){
+    if (count == 0){
+        release();
+    } else if (count < currentSize){
+        reallocate(count);
+    }
+}
+
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::extendArray(){
+    reallocate((currentSize == 0) ? START_SIZE : currentSize * 2);
+}
+
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::reallocate(int newSize){
+    ValueType *newArray = AllocatorTraits::allocate(allocator, newSize);
     for (int i = 0; i < count; i++){
-        array[i] = oldArray[i];
+        AllocatorTraits::construct(allocator, newArray + i, std::move_if_noexcept(array[i]));
+        AllocatorTraits::destroy(allocator, array + i);
     }
-    delete[] oldArray;
+    if (array != nullptr) AllocatorTraits::deallocate(allocator, array, currentSize);
+    array = newArray;
+    currentSize = newSize;
 }
 
-template<typename ValueType>
-VectorSHPP<ValueType>::~VectorSHPP(){
-    //delete[] array;
+template <typename ValueType, typename Allocator>
+void VectorSHPP<ValueType, Allocator>::release(){
+    clear();
+    if (array != nullptr) AllocatorTraits::deallocate(allocator, array, currentSize);
+    array = nullptr;
+    currentSize = 0;
 }
 
-#endif // VECTORSHPP
+template<typename ValueType, typename Allocator>
+VectorSHPP<ValueType, Allocator>::~VectorSHPP(){
+    release();
+}
 
+#endif // VECTORSHPP